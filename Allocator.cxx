@@ -149,6 +149,31 @@ namespace linalg
     Error("Error while performing an I/O operation", function, comment)
   {
   }
+  
+  
+  /* Threads */
+  
+  
+  //! Returns the number of threads available for parallel regions
+  inline int GetNbThreads()
+  {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+  
+  
+  //! Returns the number of the current thread (0 outside parallel regions)
+  inline int GetThreadNumber()
+  {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
 
 }
 
@@ -137,7 +137,10 @@ namespace linalg
   public:
     IOError(string function = "", string comment = "");
   };
-
+  
+  int GetNbThreads();
+  int GetThreadNumber();
+  
 }
 
 #define LINALG_FILE_ALLOCATOR_HXX
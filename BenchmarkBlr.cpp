@@ -0,0 +1,110 @@
+// Benchmark of the block low-rank (BLR) factorization of Mumps
+//
+// Compares full-rank and BLR factorizations of a 3D 7-point Laplacian
+// (factorization time, memory, compression ratio, residual).
+// Compilation (Mumps headers and libraries must be available) :
+//   g++ -O2 -fopenmp -I. BenchmarkBlr.cpp -o BenchmarkBlr -ldmumps -lmumps_common ...
+// Usage : ./BenchmarkBlr [nx] [tolerance]
+
+#ifndef LINALG_WITH_MUMPS
+#define LINALG_WITH_MUMPS
+#endif
+
+#include <chrono>
+#include "Linalg.hxx"
+
+using namespace std;
+using namespace linalg;
+
+//! 3D Laplacian on a nx x nx x nx grid (finite differences, 7 points)
+void GetLaplacian3D(int nx, SparseMatrix<double>& A)
+{
+  int n = nx*nx*nx;
+  A.Reallocate(n, n);
+  for (int k = 0; k < nx; k++)
+    for (int j = 0; j < nx; j++)
+      for (int i = 0; i < nx; i++)
+	{
+	  int row = i + nx*(j + nx*k);
+	  A.AddInteraction(row, row, 6.0);
+	  if (i > 0)
+	    A.AddInteraction(row, row-1, -1.0);
+
+	  if (i < nx-1)
+	    A.AddInteraction(row, row+1, -1.0);
+
+	  if (j > 0)
+	    A.AddInteraction(row, row-nx, -1.0);
+
+	  if (j < nx-1)
+	    A.AddInteraction(row, row+nx, -1.0);
+
+	  if (k > 0)
+	    A.AddInteraction(row, row-nx*nx, -1.0);
+
+	  if (k < nx-1)
+	    A.AddInteraction(row, row+nx*nx, -1.0);
+	}
+}
+
+
+//! Factorizes A (full-rank if tolerance = 0) and displays the statistics
+void RunFactorization(const SparseMatrix<double>& A, const Vector<double>& b,
+		      double tolerance, int variant)
+{
+  MatrixMumps<double> mat_lu;
+  mat_lu.HideMessages();
+  if (tolerance > 0)
+    mat_lu.EnableBlockLowRank(tolerance, variant);
+
+  SparseMatrix<double> B(A);
+  auto t0 = chrono::steady_clock::now();
+  mat_lu.Factorize(B, true);
+  double time_facto = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+  if (mat_lu.GetInfoFactorization() < 0)
+    {
+      cout << "Factorization failed, INFO(1) = " << mat_lu.GetInfoFactorization() << endl;
+      return;
+    }
+
+  Vector<double> x(b);
+  t0 = chrono::steady_clock::now();
+  mat_lu.Solve(x);
+  double time_solve = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+  Vector<double> r(b);
+  A.MltAdd(-1.0, x, r);
+
+  if (tolerance > 0)
+    cout << "BLR (eps = " << tolerance << ", variant " << variant << ")";
+  else
+    cout << "Full-rank";
+
+  cout << " : facto " << time_facto << " s, solve " << time_solve << " s, memory "
+       << mat_lu.GetMemorySize()/1e6 << " MB, compression " << mat_lu.GetCompressionRatio()
+       << ", residual " << Norm2(r)/Norm2(b) << endl;
+}
+
+
+int main(int argc, char** argv)
+{
+  int nx = 30;
+  double tolerance = 1e-6;
+  if (argc > 1)
+    nx = atoi(argv[1]);
+
+  if (argc > 2)
+    tolerance = atof(argv[2]);
+
+  SparseMatrix<double> A;
+  GetLaplacian3D(nx, A);
+  Vector<double> b(A.GetM());
+  b.FillRand();
+
+  cout << "3D Laplacian, n = " << A.GetM() << endl;
+  RunFactorization(A, b, 0.0, 0);
+  RunFactorization(A, b, tolerance, 0);
+  RunFactorization(A, b, tolerance, 1);
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef LINALG_FILE_BICGSTAB_CXX
+
+#include "BiCgStab.hxx"
+
+namespace linalg
+{
+
+  //! Constructeur par defaut
+  template<class T>
+  BiCgStabSolver<T>::BiCgStabSolver()
+  {
+    nb_iter_ = 0;
+  }
+
+
+  //! Retourne le nombre d'iterations effectuees lors du dernier appel a Solve
+  template<class T>
+  int BiCgStabSolver<T>::GetNbIterations() const
+  {
+    return nb_iter_;
+  }
+
+
+  //! Resout le systeme lineaire A x = b par BiCGStab preconditionne a droite
+  /*!
+    \param[in] A matrice associee au systeme lineaire a resoudre
+    \param[inout] x en entree "initial guess", en sortie la solution
+    \param[in] b second membre
+    \param[in] prec preconditioneur a utiliser
+    \param[in] epsilon critere d'arret (sur |b - A x| / |b|)
+    \param[in] nb_iter_max nombre maximal d'iterations
+    Les mises a jour de vecteurs et les produits scalaires d'une meme etape
+    sont faits en un seul parcours : deux produits matrice-vecteur, deux
+    applications du preconditionneur et trois reductions par iteration.
+   */
+  template<class T>
+  void BiCgStabSolver<T>::Solve(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+				VirtualPreconditioner<T>& prec, double epsilon, int nb_iter_max)
+  {
+    int n = b.GetM();
+    r_.Reallocate(n); r0_.Reallocate(n); p_.Reallocate(n); v_.Reallocate(n);
+    s_.Reallocate(n); t_.Reallocate(n); phat_.Reallocate(n); shat_.Reallocate(n);
+
+    double norm_b = abs(Norm2(b));
+    if (norm_b == 0)
+      norm_b = 1;
+
+    r_ = b;
+    A.MltAdd(T(-1), x, r_);
+    r0_ = r_;
+    p_.Zero();
+    v_.Zero();
+
+    T rho_old(1), alpha(1), omega(1);
+    T rho = DotProdConj(r0_, r_);
+    double norm_r = abs(Norm2(r_));
+    nb_iter_ = 0;
+    while ((norm_r/norm_b > epsilon) && (nb_iter_ < nb_iter_max))
+      {
+	if (rho == T(0))
+	  {
+	    cout << "BiCGStab : breakdown (rho = 0) a l'iteration " << nb_iter_ << endl;
+	    break;
+	  }
+
+	// p = r + beta (p - omega v)
+	T beta = (rho/rho_old)*(alpha/omega);
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  p_(i) = r_(i) + beta*(p_(i) - omega*v_(i));
+
+	prec.Solve(p_, phat_);
+	A.Mlt(phat_, v_);
+	alpha = rho / DotProdConj(r0_, v_);
+
+	// s = r - alpha v et |s|^2
+	double norm_s = 0;
+#pragma omp parallel for schedule(static) reduction(+:norm_s)
+	for (int i = 0; i < n; i++)
+	  {
+	    s_(i) = r_(i) - alpha*v_(i);
+	    norm_s += abs(s_(i))*abs(s_(i));
+	  }
+
+	nb_iter_++;
+	if (sqrt(norm_s)/norm_b <= epsilon)
+	  {
+	    Add(alpha, phat_, x);
+	    norm_r = sqrt(norm_s);
+	    break;
+	  }
+
+	prec.Solve(s_, shat_);
+	A.Mlt(shat_, t_);
+
+	// (t, s) et (t, t) en un seul parcours
+	T ts(0); double tt = 0;
+#pragma omp parallel
+	{
+	  T ts_loc(0); double tt_loc = 0;
+#pragma omp for schedule(static)
+	  for (int i = 0; i < n; i++)
+	    {
+	      ts_loc += conjugate(t_(i))*s_(i);
+	      tt_loc += abs(t_(i))*abs(t_(i));
+	    }
+
+#pragma omp critical
+	  {
+	    ts += ts_loc;
+	    tt += tt_loc;
+	  }
+	}
+
+	omega = (tt == 0) ? T(0) : ts/tt;
+
+	// x = x + alpha phat + omega shat, r = s - omega t, |r|^2 et (r0, r)
+	rho_old = rho;
+	T rho_new(0); double nr = 0;
+#pragma omp parallel
+	{
+	  T rho_loc(0); double nr_loc = 0;
+#pragma omp for schedule(static)
+	  for (int i = 0; i < n; i++)
+	    {
+	      x(i) += alpha*phat_(i) + omega*shat_(i);
+	      r_(i) = s_(i) - omega*t_(i);
+	      rho_loc += conjugate(r0_(i))*r_(i);
+	      nr_loc += abs(r_(i))*abs(r_(i));
+	    }
+
+#pragma omp critical
+	  {
+	    rho_new += rho_loc;
+	    nr += nr_loc;
+	  }
+	}
+
+	rho = rho_new;
+	norm_r = sqrt(nr);
+	if (nb_iter_%10 == 0)
+	  cout << "Residu at iteration " << nb_iter_ << " = " << norm_r/norm_b << endl;
+
+	if (omega == T(0))
+	  {
+	    cout << "BiCGStab : breakdown (omega = 0) a l'iteration " << nb_iter_ << endl;
+	    break;
+	  }
+      }
+  }
+
+
+  //! Resout A x = b par BiCGStab (l'espace de travail est alloue a chaque appel)
+  template<class T>
+  void BiCgStab(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+		VirtualPreconditioner<T>& prec, double epsilon, int nb_iter_max)
+  {
+    BiCgStabSolver<T> solver;
+    solver.Solve(A, x, b, prec, epsilon, nb_iter_max);
+  }
+
+}
+
+#define LINALG_FILE_BICGSTAB_CXX
+#endif
@@ -0,0 +1,40 @@
+#ifndef LINALG_FILE_BICGSTAB_HXX
+
+namespace linalg
+{
+
+  //! Methode BiCGStab avec espace de travail prealloue
+  /*!
+    Les vecteurs de travail sont conserves entre deux appels a Solve,
+    aucune allocation n'est faite tant que la taille du systeme ne change pas.
+   */
+  template<class T>
+  class BiCgStabSolver
+  {
+  protected:
+    //! vecteurs de travail
+    Vector<T> r_, r0_, p_, v_, s_, t_, phat_, shat_;
+    //! nombre d'iterations effectuees lors du dernier appel a Solve
+    int nb_iter_;
+
+  public:
+    BiCgStabSolver();
+
+    int GetNbIterations() const;
+
+    void Solve(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+	       VirtualPreconditioner<T>& prec, double epsilon = 1e-6,
+	       int nb_iter_max = 1000);
+
+  };
+
+
+  template<class T>
+  void BiCgStab(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+		VirtualPreconditioner<T>& prec, double epsilon = 1e-6,
+		int nb_iter_max = 1000);
+
+}
+
+#define LINALG_FILE_BICGSTAB_HXX
+#endif
@@ -1,6 +1,7 @@
 #ifndef LINALG_FILE_COCG_CXX
 
 #include "CoCg.hxx"
+#include "PrecondSsor.hxx"
 
 namespace linalg
 {
@@ -73,6 +74,614 @@ namespace linalg
       }
   }
 
+
+  //! Resout le systeme lineaire A x = b avec le gradient conjugue preconditionne par SSOR
+  /*!
+    Le preconditionneur SSOR (une iteration, omega = 1) est peu couteux
+    et reduit nettement le nombre d'iterations par rapport a l'identite
+   */
+  template <class T>
+  void ConjugateGradient(const SparseMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+			 double epsilon, int nb_iter_max)
+  {
+    SsorPreconditioner<T> prec;
+    prec.Init(A);
+    ConjugateGradient(A, x, b, prec, epsilon, nb_iter_max);
+  }
+  
+
+  //! Calcule G = X^T Y pour des blocs entrelaces de p et q vecteurs
+  /*!
+    \param[in] p nombre de vecteurs de X (X(p*i + a) est la composante i du vecteur a)
+    \param[in] q nombre de vecteurs de Y
+    \param[out] G matrice p x q stockee par lignes
+    \param[in] conj si true, on calcule X^H Y
+    Les produits scalaires sont calcules en un seul parcours des vecteurs.
+   */
+  template<class T>
+  void GetBlockProduct(int p, const Vector<T>& X, int q, const Vector<T>& Y,
+		       Vector<T>& G, bool conj)
+  {
+    int n = (p > 0) ? X.GetM()/p : 0;
+    G.Reallocate(p*q);
+    G.Fill(T(0));
+#pragma omp parallel
+    {
+      Vector<T> G_loc(p*q);
+      G_loc.Fill(T(0));
+#pragma omp for schedule(static)
+      for (int i = 0; i < n; i++)
+	{
+	  const T* x = &X.GetData()[size_t(p)*i];
+	  const T* y = &Y.GetData()[size_t(q)*i];
+	  T* g = G_loc.GetData();
+	  for (int a = 0; a < p; a++)
+	    {
+	      T xa = conj ? conjugate(x[a]) : x[a];
+	      for (int b = 0; b < q; b++)
+		g[q*a + b] += xa*y[b];
+	    }
+	}
+
+#pragma omp critical
+      Add(T(1), G_loc, G);
+    }
+  }
+
+
+  //! Orthonormalise les s vecteurs entrelaces de W en supprimant les vecteurs dependants
+  /*!
+    \param[in] s nombre de vecteurs de W
+    \param[inout] W vecteurs entrelaces, remplaces par une base orthonormee
+    (au sens hermitien) de l'espace engendre
+    \param[in] tol un vecteur est supprime si sa composante orthogonale aux
+    precedents est inferieure a tol fois la plus grande norme des vecteurs
+    (un residu nul a l'erreur d'arrondi pres ne donne donc pas de direction)
+    \return nombre de vecteurs conserves
+    On utilise deux passes de factorisation QR de Cholesky (W^H W = R^H R,
+    W = W R^{-1}), ce qui ne demande qu'une reduction par passe. Le produit
+    W^H W ne permet pas de detecter une dependance en dessous de la racine
+    de la precision machine, tol ne doit donc pas etre trop petit.
+   */
+  template<class T>
+  int OrthonormalizeBlock(int s, Vector<T>& W, double tol)
+  {
+    int n = (s > 0) ? W.GetM()/s : 0;
+    Vector<T> G, R;
+    Vector<int> keep;
+    for (int pass = 0; pass < 2; pass++)
+      {
+	if (s == 0)
+	  break;
+
+	GetBlockProduct(s, W, s, W, G, true);
+	double norm_max = 0;
+	for (int k = 0; k < s; k++)
+	  norm_max = max(norm_max, real(G(s*k + k)));
+
+	// factorisation de Cholesky de G, les colonnes dependantes sont ignorees
+	R.Reallocate(s*s);
+	R.Fill(T(0));
+	keep.Reallocate(s);
+	int nb_keep = 0;
+	for (int k = 0; k < s; k++)
+	  {
+	    double d = real(G(s*k + k));
+	    for (int a = 0; a < nb_keep; a++)
+	      d -= real(conjugate(R(s*keep(a) + k))*R(s*keep(a) + k));
+
+	    if ((d <= 0) || (d <= tol*tol*norm_max))
+	      continue;
+
+	    R(s*k + k) = T(sqrt(d));
+	    for (int l = k+1; l < s; l++)
+	      {
+		T val = G(s*k + l);
+		for (int a = 0; a < nb_keep; a++)
+		  val -= conjugate(R(s*keep(a) + k))*R(s*keep(a) + l);
+
+		R(s*k + l) = val / R(s*k + k);
+	      }
+
+	    keep(nb_keep++) = k;
+	  }
+
+	// inverse de R restreinte aux colonnes conservees (triangulaire superieure)
+	Vector<T> invR(nb_keep*nb_keep);
+	invR.Fill(T(0));
+	for (int a = nb_keep-1; a >= 0; a--)
+	  {
+	    invR(nb_keep*a + a) = T(1) / R(s*keep(a) + keep(a));
+	    for (int c = a+1; c < nb_keep; c++)
+	      {
+		T val(0);
+		for (int b = a+1; b <= c; b++)
+		  val += R(s*keep(a) + keep(b))*invR(nb_keep*b + c);
+
+		invR(nb_keep*a + c) = -val*invR(nb_keep*a + a);
+	      }
+	  }
+
+	// W = W(:, keep) R^{-1}, ligne par ligne (les lignes sont tassees sur place)
+	Vector<T> row(nb_keep);
+	for (int i = 0; i < n; i++)
+	  {
+	    const T* w = &W.GetData()[size_t(s)*i];
+	    row.Fill(T(0));
+	    for (int b = 0; b < nb_keep; b++)
+	      {
+		T wb = w[keep(b)];
+		const T* r = &invR.GetData()[nb_keep*b];
+		for (int a = b; a < nb_keep; a++)
+		  row(a) += wb*r[a];
+	      }
+
+	    T* y = &W.GetData()[size_t(nb_keep)*i];
+	    for (int a = 0; a < nb_keep; a++)
+	      y[a] = row(a);
+	  }
+
+	W.Resize(size_t(nb_keep)*n);
+	s = nb_keep;
+      }
+
+    return s;
+  }
+
+
+  //! Applique le preconditionneur a chacun des nrhs vecteurs entrelaces de R
+  template<class T>
+  void ApplyPreconditionerBlock(VirtualPreconditioner<T>& prec, int nrhs,
+				const Vector<T>& R, Vector<T>& Z)
+  {
+    int n = R.GetM()/nrhs;
+    Vector<T> r(n), z(n);
+    Z.Reallocate(R.GetM());
+    for (int k = 0; k < nrhs; k++)
+      {
+	for (int i = 0; i < n; i++)
+	  r(i) = R(size_t(nrhs)*i + k);
+
+	prec.Solve(r, z);
+	for (int i = 0; i < n; i++)
+	  Z(size_t(nrhs)*i + k) = z(i);
+      }
+  }
+
+
+  //! Retourne la plus grande norme relative |R_k| / |B_k| des nrhs vecteurs entrelaces
+  template<class T>
+  double GetBlockResidual(int nrhs, const Vector<T>& R, const Vector<T>& B)
+  {
+    Vector<double> norm_r(nrhs), norm_b(nrhs);
+    norm_r.Fill(0.0);
+    norm_b.Fill(0.0);
+    int n = R.GetM()/nrhs;
+    for (int i = 0; i < n; i++)
+      for (int k = 0; k < nrhs; k++)
+	{
+	  norm_r(k) += real(conjugate(R(size_t(nrhs)*i + k))*R(size_t(nrhs)*i + k));
+	  norm_b(k) += real(conjugate(B(size_t(nrhs)*i + k))*B(size_t(nrhs)*i + k));
+	}
+
+    double res = 0;
+    for (int k = 0; k < nrhs; k++)
+      if (norm_b(k) > 0)
+	res = max(res, sqrt(norm_r(k)/norm_b(k)));
+      else
+	res = max(res, sqrt(norm_r(k)));
+
+    return res;
+  }
+
+
+  //! Gradient conjugue par blocs pour plusieurs seconds membres
+  /*!
+    \param[in] A matrice associee au systeme lineaire a resoudre
+    \param[inout] X en entree "initial guess", en sortie les solutions
+    \param[in] B seconds membres
+    \param[in] nrhs nombre de seconds membres (les vecteurs sont entrelaces :
+    X(nrhs*i + k) est la composante i de la solution k)
+    \param[in] prec preconditioneur (applique a chaque vecteur)
+    \param[in] epsilon critere d'arret (pour chaque second membre)
+    \param[in] nb_iter_max nombre maximal d'iterations
+    Les directions de descente des nrhs systemes sont combinees, la matrice
+    n'est lue qu'une fois par iteration (MltBlock). Comme pour
+    ConjugateGradient, les produits scalaires ne sont pas conjugues (matrices
+    reelles symetriques ou complexes symetriques). A chaque iteration, le bloc
+    des directions est orthonormalise et les directions dependantes (par
+    exemple celles des seconds membres ayant converge) sont supprimees, ce
+    qui evite la rupture de l'algorithme.
+   */
+  template <class T>
+  void BlockConjugateGradient(const VirtualMatrix<T>& A, Vector<T>& X, const Vector<T>& B,
+			      int nrhs, VirtualPreconditioner<T>& prec,
+			      double epsilon, int nb_iter_max)
+  {
+    int n = A.GetM();
+    Vector<T> R, Z, P, Q, G, H, E, rhs;
+    Vector<int> pivot;
+
+    // R = B - A X
+    A.MltBlock(nrhs, X, R);
+    for (size_t i = 0; i < R.GetSize(); i++)
+      R(i) = B(i) - R(i);
+
+    // les directions sont mises a l'echelle de chaque second membre avant
+    // l'orthonormalisation, le seuil de suppression est ainsi relatif au
+    // critere d'arret de chaque systeme
+    Vector<double> scale(nrhs);
+    scale.Fill(0.0);
+    for (int i = 0; i < n; i++)
+      for (int k = 0; k < nrhs; k++)
+	scale(k) += real(conjugate(B(size_t(nrhs)*i + k))*B(size_t(nrhs)*i + k));
+
+    for (int k = 0; k < nrhs; k++)
+      scale(k) = (scale(k) > 0) ? 1.0/sqrt(scale(k)) : 1.0;
+
+    ApplyPreconditionerBlock(prec, nrhs, R, Z);
+    for (int i = 0; i < n; i++)
+      for (int k = 0; k < nrhs; k++)
+	Z(size_t(nrhs)*i + k) *= scale(k);
+
+    P = Z;
+    int s = OrthonormalizeBlock(nrhs, P);
+
+    int nb_iter = 0;
+    double res = GetBlockResidual(nrhs, R, B);
+    while ((res > epsilon) && (s > 0) && (nb_iter < nb_iter_max))
+      {
+	// Q = A P, G = P^T Q, H = P^T R
+	A.MltBlock(s, P, Q);
+	GetBlockProduct(s, P, s, Q, G);
+	GetBlockProduct(s, P, nrhs, R, H);
+
+	// alpha = G^{-1} H, stocke dans H
+	GetLU(s, G, pivot);
+	rhs.Reallocate(s);
+	for (int k = 0; k < nrhs; k++)
+	  {
+	    for (int a = 0; a < s; a++)
+	      rhs(a) = H(nrhs*a + k);
+
+	    SolveLU(s, G, pivot, rhs);
+	    for (int a = 0; a < s; a++)
+	      H(nrhs*a + k) = rhs(a);
+	  }
+
+	// X = X + P alpha, R = R - Q alpha
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  for (int a = 0; a < s; a++)
+	    {
+	      T p = P(size_t(s)*i + a), q = Q(size_t(s)*i + a);
+	      for (int k = 0; k < nrhs; k++)
+		{
+		  X(size_t(nrhs)*i + k) += p*H(nrhs*a + k);
+		  R(size_t(nrhs)*i + k) -= q*H(nrhs*a + k);
+		}
+	    }
+
+	nb_iter++;
+	res = GetBlockResidual(nrhs, R, B);
+	if (nb_iter%10 == 0)
+	  cout << "Residu at iteration " << nb_iter << " = " << res << endl;
+
+	if (res <= epsilon)
+	  break;
+
+	// beta = -G^{-1} Q^T Z, stocke dans E
+	ApplyPreconditionerBlock(prec, nrhs, R, Z);
+	GetBlockProduct(s, Q, nrhs, Z, E);
+	for (int k = 0; k < nrhs; k++)
+	  {
+	    for (int a = 0; a < s; a++)
+	      rhs(a) = -E(nrhs*a + k);
+
+	    SolveLU(s, G, pivot, rhs);
+	    for (int a = 0; a < s; a++)
+	      E(nrhs*a + k) = rhs(a);
+	  }
+
+	// nouvelles directions P = orth(Z + P beta)
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  for (int a = 0; a < s; a++)
+	    {
+	      T p = P(size_t(s)*i + a);
+	      for (int k = 0; k < nrhs; k++)
+		Z(size_t(nrhs)*i + k) += p*E(nrhs*a + k);
+	    }
+
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  for (int k = 0; k < nrhs; k++)
+	    Z(size_t(nrhs)*i + k) *= scale(k);
+
+	P = Z;
+	s = OrthonormalizeBlock(nrhs, P);
+      }
+  }
+
+
+  //! Calcule les produits (r, u), (w, u) (sans conjugaison) et |r|^2 en une seule boucle
+  template<class T>
+  void GetPipelinedProducts(const Vector<T>& r, const Vector<T>& u, const Vector<T>& w,
+			    T& gamma, T& delta, double& norm_r)
+  {
+    gamma = T(0);
+    delta = T(0);
+    norm_r = 0;
+#pragma omp parallel
+    {
+      T gamma_loc(0), delta_loc(0);
+      double norm_loc = 0;
+#pragma omp for schedule(static)
+      for (int i = 0; i < r.GetM(); i++)
+	{
+	  gamma_loc += r(i)*u(i);
+	  delta_loc += w(i)*u(i);
+	  norm_loc += real(conjugate(r(i))*r(i));
+	}
+
+#pragma omp critical
+      {
+	gamma += gamma_loc;
+	delta += delta_loc;
+	norm_r += norm_loc;
+      }
+    }
+  }
+
+
+  //! Gradient conjugue pipeline (Ghysels et Vanroose)
+  /*!
+    \param[in] A matrice associee au systeme lineaire a resoudre
+    \param[inout] x en entree "initial guess", en sortie la solution
+    \param[in] b second membre
+    \param[in] prec preconditioneur a utiliser
+    \param[in] epsilon critere d'arret
+    \param[in] nb_iter_max nombre maximal d'iterations
+    Variante de ConjugateGradient (COCG, produits scalaires sans conjugaison)
+    avec une seule reduction par iteration : les produits (r, u), (w, u) et
+    la norme du residu sont calcules dans la meme boucle que les mises a jour
+    des vecteurs, et ne sont utilises qu'apres le preconditionnement et le
+    produit matrice-vecteur de l'iteration suivante (la reduction peut donc
+    etre recouverte par ces operations). Les recurrences supplementaires
+    coutent quatre combinaisons lineaires par iteration. Lorsque le residu
+    calcule par recurrence atteint le critere d'arret, le vrai residu
+    b - A x est recalcule et l'algorithme redemarre s'il est trop grand.
+   */
+  template <class T>
+  void PipelinedConjugateGradient(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+				  VirtualPreconditioner<T>& prec, double epsilon, int nb_iter_max)
+  {
+    int n = b.GetM();
+    T alpha(0), beta(0), gamma, delta, gamma_1(1), alpha_1(1);
+    double norm_r, norm_b = abs(Norm2(b));
+    if (norm_b == 0)
+      norm_b = 1;
+
+    Vector<T> r(b), u(n), w(n), m(n), nv(n), p(n), s(n), q(n), z(n);
+    p.Fill(T(0)); s.Fill(T(0)); q.Fill(T(0)); z.Fill(T(0));
+
+    // r = b - A x, u = M^{-1} r, w = A u
+    A.MltAdd(T(-1), x, r);
+    prec.Solve(r, u);
+    A.Mlt(u, w);
+    GetPipelinedProducts(r, u, w, gamma, delta, norm_r);
+
+    bool restart = true;
+    int nb_iter = 0;
+    while (nb_iter < nb_iter_max)
+      {
+	if (sqrt(norm_r)/norm_b <= epsilon)
+	  {
+	    // verification sur le vrai residu
+	    r = b;
+	    A.MltAdd(T(-1), x, r);
+	    if (abs(Norm2(r))/norm_b <= epsilon)
+	      break;
+
+	    prec.Solve(r, u);
+	    A.Mlt(u, w);
+	    GetPipelinedProducts(r, u, w, gamma, delta, norm_r);
+	    restart = true;
+	  }
+
+	// m = M^{-1} w et nv = A m
+	prec.Solve(w, m);
+	A.Mlt(m, nv);
+
+	// les produits de la reduction ne sont utilises qu'ici
+	if (restart)
+	  {
+	    beta = T(0);
+	    alpha = gamma / delta;
+	    restart = false;
+	  }
+	else
+	  {
+	    beta = gamma / gamma_1;
+	    alpha = gamma / (delta - beta*gamma/alpha_1);
+	  }
+
+	gamma_1 = gamma;
+	alpha_1 = alpha;
+
+	// mises a jour fusionnees avec la reduction de l'iteration suivante
+	gamma = T(0);
+	delta = T(0);
+	norm_r = 0;
+#pragma omp parallel
+	{
+	  T gamma_loc(0), delta_loc(0);
+	  double norm_loc = 0;
+#pragma omp for schedule(static)
+	  for (int i = 0; i < n; i++)
+	    {
+	      z(i) = nv(i) + beta*z(i);
+	      q(i) = m(i) + beta*q(i);
+	      s(i) = w(i) + beta*s(i);
+	      p(i) = u(i) + beta*p(i);
+	      x(i) += alpha*p(i);
+	      r(i) -= alpha*s(i);
+	      u(i) -= alpha*q(i);
+	      w(i) -= alpha*z(i);
+
+	      gamma_loc += r(i)*u(i);
+	      delta_loc += w(i)*u(i);
+	      norm_loc += real(conjugate(r(i))*r(i));
+	    }
+
+#pragma omp critical
+	  {
+	    gamma += gamma_loc;
+	    delta += delta_loc;
+	    norm_r += norm_loc;
+	  }
+	}
+
+	nb_iter++;
+	if (nb_iter%10 == 0)
+	  cout << "Residu at iteration " << nb_iter << " = " << sqrt(norm_r)/norm_b << endl;
+      }
+  }
+
+
+  //! Resout les systemes (A + shift_k I) x_k = b pour tous les decalages en une seule resolution
+  /*!
+    \param[in] A matrice complexe symetrique (ou reelle symetrique)
+    \param[out] x solutions x(k) (la donnee initiale est nulle)
+    \param[in] b second membre
+    \param[in] shift decalages, le premier sert de systeme "graine"
+    \param[in] epsilon critere d'arret (sur chaque systeme)
+    \param[in] nb_iter_max nombre maximal d'iterations
+    Les espaces de Krylov etant invariants par decalage, seul le systeme graine
+    demande un produit matrice-vecteur par iteration : les residus des autres
+    systemes sont colineaires a celui de la graine (r_k = zeta_k r). Chaque
+    systeme est retire des mises a jour des qu'il a converge. Le systeme graine
+    doit etre le plus lent a converger (decalage le plus proche du spectre).
+    Aucun preconditionneur n'est utilise, il detruirait l'invariance par decalage.
+   */
+  template <class T>
+  void MultiShiftConjugateGradient(const VirtualMatrix<T>& A, Vector<Vector<T> >& x,
+				   const Vector<T>& b, const Vector<T>& shift,
+				   double epsilon, int nb_iter_max)
+  {
+    int n = b.GetM(), nb_shift = shift.GetM();
+    double norm_b = abs(Norm2(b));
+    if (norm_b == 0)
+      norm_b = 1;
+
+    // x(0) et p(0) correspondent au systeme graine
+    Vector<Vector<T> > p(nb_shift);
+    x.Reallocate(nb_shift);
+    for (int k = 0; k < nb_shift; k++)
+      {
+	x(k).Reallocate(n);
+	x(k).Fill(T(0));
+	p(k) = b;
+      }
+
+    Vector<T> r(b), q(n);
+    Vector<T> zeta(nb_shift), zeta_1(nb_shift), alpha_k(nb_shift), beta_k(nb_shift);
+    zeta.Fill(T(1));
+    zeta_1.Fill(T(1));
+
+    // systemes non converges (autres que la graine)
+    Vector<int> active;
+    for (int k = 1; k < nb_shift; k++)
+      active.PushBack(k);
+
+    T alpha, beta, alpha_1(1), beta_1(0);
+    T rho = DotProd(r, r);
+    double norm_r = abs(Norm2(r));
+    int nb_iter = 0;
+    while (nb_iter < nb_iter_max)
+      {
+	if ((norm_r/norm_b <= epsilon) && (active.GetM() == 0))
+	  break;
+
+	// q = (A + shift_0 I) p_0
+	A.Mlt(p(0), q);
+	Add(shift(0), p(0), q);
+	alpha = rho / DotProd(p(0), q);
+
+	// r = r - alpha q, (r, r) et |r|^2
+	T rho_new(0);
+	double norm2 = 0;
+#pragma omp parallel
+	{
+	  T rho_loc(0);
+	  double norm_loc = 0;
+#pragma omp for schedule(static)
+	  for (int i = 0; i < n; i++)
+	    {
+	      r(i) -= alpha*q(i);
+	      rho_loc += r(i)*r(i);
+	      norm_loc += abs(r(i))*abs(r(i));
+	    }
+
+#pragma omp critical
+	  {
+	    rho_new += rho_loc;
+	    norm2 += norm_loc;
+	  }
+	}
+
+	beta = rho_new / rho;
+	rho = rho_new;
+	norm_r = sqrt(norm2);
+
+	// coefficients des systemes decales
+	int nb_active = active.GetM();
+	for (int j = 0; j < nb_active; j++)
+	  {
+	    int k = active(j);
+	    T delta = shift(k) - shift(0);
+	    T zeta_new = zeta(k)*zeta_1(k)*alpha_1
+	      / (alpha_1*zeta_1(k)*(T(1) + alpha*delta) + alpha*beta_1*(zeta_1(k) - zeta(k)));
+
+	    alpha_k(k) = alpha*zeta_new/zeta(k);
+	    beta_k(k) = beta*(zeta_new/zeta(k))*(zeta_new/zeta(k));
+	    zeta_1(k) = zeta(k);
+	    zeta(k) = zeta_new;
+	  }
+
+	// mises a jour de x et p pour la graine et les systemes actifs
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  {
+	    x(0)(i) += alpha*p(0)(i);
+	    p(0)(i) = r(i) + beta*p(0)(i);
+	    for (int j = 0; j < nb_active; j++)
+	      {
+		int k = active(j);
+		x(k)(i) += alpha_k(k)*p(k)(i);
+		p(k)(i) = zeta(k)*r(i) + beta_k(k)*p(k)(i);
+	      }
+	  }
+
+	alpha_1 = alpha;
+	beta_1 = beta;
+
+	// on retire les systemes converges (residu zeta_k r)
+	int nb = 0;
+	for (int j = 0; j < nb_active; j++)
+	  if (abs(zeta(active(j)))*norm_r/norm_b > epsilon)
+	    active(nb++) = active(j);
+
+	if (nb < nb_active)
+	  active.Resize(nb);
+
+	nb_iter++;
+	if (nb_iter%10 == 0)
+	  cout << "Residu at iteration " << nb_iter << " = " << norm_r/norm_b
+	       << " (" << active.GetM() << " systemes decales actifs)" << endl;
+      }
+  }
+
 }
 
 #define LINALG_FILE_COCG_CXX
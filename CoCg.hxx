@@ -18,6 +18,32 @@ namespace linalg
   void ConjugateGradient(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
                          VirtualPreconditioner<T>& prec, double epsilon = 1e-6, int nb_iter_max = 1000);
   
+  template <class T>
+  void ConjugateGradient(const SparseMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+                         double epsilon = 1e-6, int nb_iter_max = 1000);
+
+  template <class T>
+  void PipelinedConjugateGradient(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+                                  VirtualPreconditioner<T>& prec, double epsilon = 1e-6,
+                                  int nb_iter_max = 1000);
+  
+  template <class T>
+  void BlockConjugateGradient(const VirtualMatrix<T>& A, Vector<T>& X, const Vector<T>& B,
+                              int nrhs, VirtualPreconditioner<T>& prec,
+                              double epsilon = 1e-6, int nb_iter_max = 1000);
+
+  template <class T>
+  void MultiShiftConjugateGradient(const VirtualMatrix<T>& A, Vector<Vector<T> >& x,
+                                   const Vector<T>& b, const Vector<T>& shift,
+                                   double epsilon = 1e-6, int nb_iter_max = 1000);
+
+  template<class T>
+  void GetBlockProduct(int p, const Vector<T>& X, int q, const Vector<T>& Y,
+                       Vector<T>& G, bool conj = false);
+
+  template<class T>
+  int OrthonormalizeBlock(int s, Vector<T>& W, double tol = 1e-6);
+  
   //! Preconditioneur identite (M = I)
   template<class T>
   class IdentityPreconditioner : public VirtualPreconditioner<T>
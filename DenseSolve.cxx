@@ -0,0 +1,247 @@
+#ifndef LINALG_FILE_DENSE_SOLVE_CXX
+
+#include "DenseSolve.hxx"
+
+namespace linalg
+{
+  
+  //! Factorisation LU d'une petite matrice dense avec pivot partiel
+  /*!
+    \param[in] n taille de la matrice
+    \param[inout] A matrice stockee par lignes (A(i, j) = A(n*i + j)),
+    remplacee par ses facteurs L (diagonale unite) et U
+    \param[out] pivot ligne echangee avec la ligne i lors de l'etape i
+   */
+  template<class T>
+  void GetLU(int n, Vector<T>& A, Vector<int>& pivot)
+  {
+    pivot.Reallocate(n);
+    for (int k = 0; k < n; k++)
+      {
+	// recherche du pivot
+	int p = k;
+	for (int i = k+1; i < n; i++)
+	  if (abs(A(n*i + k)) > abs(A(n*p + k)))
+	    p = i;
+	
+	pivot(k) = p;
+	if (A(n*p + k) == T(0))
+	  {
+	    cout << "matrice dense singuliere (colonne " << k << ")" << endl;
+	    abort();
+	  }
+	
+	if (p != k)
+	  for (int j = 0; j < n; j++)
+	    swap(A(n*k + j), A(n*p + j));
+	
+	T inv_pivot = T(1) / A(n*k + k);
+	for (int i = k+1; i < n; i++)
+	  {
+	    T coef = A(n*i + k)*inv_pivot;
+	    A(n*i + k) = coef;
+	    for (int j = k+1; j < n; j++)
+	      A(n*i + j) -= coef*A(n*k + j);
+	  }
+      }
+  }
+  
+  
+  //! Resout A x = b a partir de la factorisation calculee par GetLU
+  /*!
+    \param[inout] x second membre en entree, solution en sortie
+   */
+  template<class T>
+  void SolveLU(int n, const Vector<T>& A, const Vector<int>& pivot, Vector<T>& x)
+  {
+    for (int k = 0; k < n; k++)
+      if (pivot(k) != k)
+	swap(x(k), x(pivot(k)));
+    
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < i; j++)
+	x(i) -= A(n*i + j)*x(j);
+    
+    for (int i = n-1; i >= 0; i--)
+      {
+	for (int j = i+1; j < n; j++)
+	  x(i) -= A(n*i + j)*x(j);
+	
+	x(i) /= A(n*i + i);
+      }
+  }
+  
+  
+  //! Remplace la petite matrice dense A (stockee par lignes) par son inverse
+  template<class T>
+  void GetInverse(int n, Vector<T>& A)
+  {
+    Vector<T> lu(A), x(n);
+    Vector<int> pivot;
+    GetLU(n, lu, pivot);
+    for (int j = 0; j < n; j++)
+      {
+	x.Fill(T(0));
+	x(j) = T(1);
+	SolveLU(n, lu, pivot, x);
+	for (int i = 0; i < n; i++)
+	  A(n*i + j) = x(i);
+      }
+  }
+  
+  
+  //! Resout le probleme aux moindres carres min |A x - b| par factorisation QR
+  /*!
+    \param[in] m nombre de lignes de A
+    \param[in] n nombre de colonnes de A (n <= m)
+    \param[inout] A matrice stockee par lignes (A(i, j) = A(n*i + j)), detruite
+    \param[inout] b second membre (de taille m) en entree, la solution est
+    stockee dans les n premieres composantes en sortie
+    La factorisation utilise des reflexions de Householder (avec conjugaison
+    dans le cas complexe).
+   */
+  template<class T>
+  void SolveLeastSquares(int m, int n, Vector<T>& A, Vector<T>& b)
+  {
+    Vector<T> v(m);
+    for (int k = 0; k < n; k++)
+      {
+	double norm = 0;
+	for (int i = k; i < m; i++)
+	  norm += abs(A(n*i + k))*abs(A(n*i + k));
+	
+	norm = sqrt(norm);
+	if (norm == 0)
+	  {
+	    cout << "matrice de rang incomplet (colonne " << k << ")" << endl;
+	    abort();
+	  }
+	
+	// reflexion envoyant la colonne k sur beta e_k
+	T phase(1);
+	if (abs(A(n*k + k)) > 0)
+	  phase = A(n*k + k) / abs(A(n*k + k));
+	
+	T beta = -phase*norm;
+	double norm_v = 0;
+	for (int i = k; i < m; i++)
+	  {
+	    v(i) = A(n*i + k);
+	    if (i == k)
+	      v(i) -= beta;
+	    
+	    norm_v += abs(v(i))*abs(v(i));
+	  }
+	
+	// application aux colonnes suivantes et au second membre
+	for (int j = k+1; j < n; j++)
+	  {
+	    T val(0);
+	    for (int i = k; i < m; i++)
+	      val += conjugate(v(i))*A(n*i + j);
+	    
+	    val *= 2.0/norm_v;
+	    for (int i = k; i < m; i++)
+	      A(n*i + j) -= val*v(i);
+	  }
+	
+	T val(0);
+	for (int i = k; i < m; i++)
+	  val += conjugate(v(i))*b(i);
+	
+	val *= 2.0/norm_v;
+	for (int i = k; i < m; i++)
+	  b(i) -= val*v(i);
+	
+	A(n*k + k) = beta;
+      }
+    
+    // resolution de R x = Q^H b
+    for (int i = n-1; i >= 0; i--)
+      {
+	for (int j = i+1; j < n; j++)
+	  b(i) -= A(n*i + j)*b(j);
+	
+	b(i) /= A(n*i + i);
+      }
+  }
+  
+  //! Diagonalise une petite matrice symetrique A = V diag(lambda) V^T (methode de Jacobi)
+  /*!
+    \param[in] n taille de la matrice
+    \param[inout] A matrice symetrique stockee par lignes, detruite
+    \param[out] lambda valeurs propres (non triees)
+    \param[out] V vecteurs propres stockes par colonnes (V(n*i + j) = v_j(i))
+    Aucune conjugaison n'est utilisee : pour une matrice complexe symetrique,
+    on obtient V^T V = I (rotations complexes orthogonales), comme dans COCG.
+   */
+  template<class T>
+  void GetSymmetricEigenvalues(int n, Vector<T>& A, Vector<T>& lambda, Vector<T>& V)
+  {
+    V.Reallocate(n*n);
+    V.Fill(T(0));
+    for (int i = 0; i < n; i++)
+      V(n*i + i) = T(1);
+    
+    double norm = 0;
+    for (int i = 0; i < n*n; i++)
+      norm += abs(A(i))*abs(A(i));
+    
+    for (int sweep = 0; sweep < 50; sweep++)
+      {
+	double off = 0;
+	for (int p = 0; p < n; p++)
+	  for (int q = p+1; q < n; q++)
+	    off += abs(A(n*p + q))*abs(A(n*p + q));
+	
+	if (off <= 1e-30*norm)
+	  break;
+	
+	for (int p = 0; p < n; p++)
+	  for (int q = p+1; q < n; q++)
+	    {
+	      T apq = A(n*p + q);
+	      if (abs(apq) == 0)
+		continue;
+	      
+	      // t racine de plus petit module de t^2 + 2 theta t - 1 = 0
+	      T theta = (A(n*q + q) - A(n*p + p)) / (T(2)*apq);
+	      T root = sqrt(theta*theta + T(1));
+	      T den = (abs(theta + root) >= abs(theta - root)) ? theta + root : theta - root;
+	      T t = T(1) / den;
+	      T c2 = T(1) + t*t;
+	      if (abs(c2) < 1e-12)
+		continue;
+	      
+	      T c = T(1) / sqrt(c2), s = t*c;
+	      A(n*p + p) -= t*apq;
+	      A(n*q + q) += t*apq;
+	      A(n*p + q) = T(0);
+	      A(n*q + p) = T(0);
+	      for (int r = 0; r < n; r++)
+		{
+		  if ((r != p) && (r != q))
+		    {
+		      T arp = A(n*r + p), arq = A(n*r + q);
+		      A(n*r + p) = c*arp - s*arq;
+		      A(n*p + r) = A(n*r + p);
+		      A(n*r + q) = s*arp + c*arq;
+		      A(n*q + r) = A(n*r + q);
+		    }
+		  
+		  T vrp = V(n*r + p), vrq = V(n*r + q);
+		  V(n*r + p) = c*vrp - s*vrq;
+		  V(n*r + q) = s*vrp + c*vrq;
+		}
+	    }
+      }
+    
+    lambda.Reallocate(n);
+    for (int i = 0; i < n; i++)
+      lambda(i) = A(n*i + i);
+  }
+  
+}
+
+#define LINALG_FILE_DENSE_SOLVE_CXX
+#endif
@@ -0,0 +1,24 @@
+#ifndef LINALG_FILE_DENSE_SOLVE_HXX
+
+namespace linalg
+{
+  
+  template<class T>
+  void GetLU(int n, Vector<T>& A, Vector<int>& pivot);
+  
+  template<class T>
+  void SolveLU(int n, const Vector<T>& A, const Vector<int>& pivot, Vector<T>& x);
+  
+  template<class T>
+  void GetInverse(int n, Vector<T>& A);
+  
+  template<class T>
+  void SolveLeastSquares(int m, int n, Vector<T>& A, Vector<T>& b);
+  
+  template<class T>
+  void GetSymmetricEigenvalues(int n, Vector<T>& A, Vector<T>& lambda, Vector<T>& V);
+  
+}
+
+#define LINALG_FILE_DENSE_SOLVE_HXX
+#endif
@@ -0,0 +1,243 @@
+#ifndef LINALG_FILE_GMRES_CXX
+
+#include "Gmres.hxx"
+
+namespace linalg
+{
+
+  //! Constructeur par defaut (redemarrage toutes les 30 iterations)
+  template<class T>
+  GmresSolver<T>::GmresSolver()
+  {
+    restart_ = 30;
+    nb_iter_ = 0;
+  }
+
+
+  //! Change le nombre d'iterations avant redemarrage
+  template<class T>
+  void GmresSolver<T>::SetRestart(int m)
+  {
+    restart_ = m;
+  }
+
+
+  //! Retourne le nombre d'iterations effectuees lors du dernier appel a Solve
+  template<class T>
+  int GmresSolver<T>::GetNbIterations() const
+  {
+    return nb_iter_;
+  }
+
+
+  //! Alloue l'espace de travail (rien n'est fait si les tailles n'ont pas change)
+  template<class T>
+  void GmresSolver<T>::Reallocate(int n)
+  {
+    int m = restart_;
+    V_.Reallocate(m+1);
+    for (int k = 0; k <= m; k++)
+      V_(k).Reallocate(n);
+
+    H_.Reallocate((m+1)*m);
+    cs_.Reallocate(m);
+    sn_.Reallocate(m);
+    g_.Reallocate(m+1);
+    h_.Reallocate(m+1);
+    h2_.Reallocate(m+1);
+    h_thread_.Reallocate(size_t(GetNbThreads())*(m+1));
+    w_.Reallocate(n);
+    z_.Reallocate(n);
+  }
+
+
+  //! Orthogonalise w_ par rapport a v_0, ..., v_j et stocke les coefficients dans h_
+  /*!
+    Gram-Schmidt classique avec reorthogonalisation (CGS2) : chaque passe
+    calcule tous les produits scalaires (v_k, w) en un seul parcours des
+    vecteurs, puis retranche toutes les projections en un second parcours.
+    Deux passes donnent une orthogonalite comparable a Gram-Schmidt modifie
+    avec deux reductions par iteration au lieu de j+1.
+   */
+  template<class T>
+  void GmresSolver<T>::Orthogonalize(int j)
+  {
+    int n = w_.GetM();
+    for (int k = 0; k <= j; k++)
+      h_(k) = T(0);
+
+    for (int pass = 0; pass < 2; pass++)
+      {
+	for (int k = 0; k <= j; k++)
+	  h2_(k) = T(0);
+
+	// produits scalaires fusionnes
+#pragma omp parallel
+	{
+	  T* h_loc = &h_thread_.GetData()[size_t(GetThreadNumber())*(restart_+1)];
+	  for (int k = 0; k <= j; k++)
+	    h_loc[k] = T(0);
+
+#pragma omp for schedule(static)
+	  for (int i = 0; i < n; i++)
+	    for (int k = 0; k <= j; k++)
+	      h_loc[k] += conjugate(V_(k)(i))*w_(i);
+
+#pragma omp critical
+	  for (int k = 0; k <= j; k++)
+	    h2_(k) += h_loc[k];
+	}
+
+	// w = w - sum_k h_k v_k
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  {
+	    T val = w_(i);
+	    for (int k = 0; k <= j; k++)
+	      val -= h2_(k)*V_(k)(i);
+
+	    w_(i) = val;
+	  }
+
+	for (int k = 0; k <= j; k++)
+	  h_(k) += h2_(k);
+      }
+  }
+
+
+  //! Resout le systeme lineaire A x = b par GMRES(m) preconditionne a droite
+  /*!
+    \param[in] A matrice associee au systeme lineaire a resoudre
+    \param[inout] x en entree "initial guess", en sortie la solution
+    \param[in] b second membre
+    \param[in] prec preconditioneur a utiliser
+    \param[in] epsilon critere d'arret (sur |b - A x| / |b|)
+    \param[in] nb_iter_max nombre maximal d'iterations
+    Contrairement a ConjugateGradient, la methode converge pour des matrices
+    quelconques (non-symetriques, hermitiennes). Le preconditionnement a
+    droite (A M^{-1} y = b, x = M^{-1} y) fait que le residu minimise est le
+    vrai residu b - A x.
+   */
+  template<class T>
+  void GmresSolver<T>::Solve(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+			     VirtualPreconditioner<T>& prec, double epsilon, int nb_iter_max)
+  {
+    int n = b.GetM(), m = restart_;
+    Reallocate(n);
+    double norm_b = abs(Norm2(b));
+    if (norm_b == 0)
+      norm_b = 1;
+
+    nb_iter_ = 0;
+    while (nb_iter_ < nb_iter_max)
+      {
+	// residu r = b - A x stocke dans v_0
+	Vector<T>& r = V_(0);
+	r = b;
+	A.MltAdd(T(-1), x, r);
+	double beta = abs(Norm2(r));
+	if (beta/norm_b <= epsilon)
+	  break;
+
+	r *= T(1.0/beta);
+	g_.Fill(T(0));
+	g_(0) = beta;
+
+	// processus d'Arnoldi
+	int j = 0;
+	double res = beta;
+	while ((j < m) && (nb_iter_ < nb_iter_max))
+	  {
+	    prec.Solve(V_(j), z_);
+	    A.Mlt(z_, w_);
+	    Orthogonalize(j);
+
+	    double norm_w = abs(Norm2(w_));
+	    for (int k = 0; k <= j; k++)
+	      H_(m*k + j) = h_(k);
+
+	    H_(m*(j+1) + j) = norm_w;
+
+	    // rotations de Givens precedentes
+	    for (int k = 0; k < j; k++)
+	      {
+		T x0 = H_(m*k + j), x1 = H_(m*(k+1) + j);
+		H_(m*k + j) = cs_(k)*x0 + sn_(k)*x1;
+		H_(m*(k+1) + j) = -conjugate(sn_(k))*x0 + cs_(k)*x1;
+	      }
+
+	    // nouvelle rotation annulant H(j+1, j)
+	    T a = H_(m*j + j);
+	    double t = sqrt(abs(a)*abs(a) + norm_w*norm_w);
+	    if (abs(a) == 0)
+	      {
+		cs_(j) = T(0);
+		sn_(j) = T(1);
+	      }
+	    else
+	      {
+		cs_(j) = T(abs(a)/t);
+		sn_(j) = a/abs(a)*T(norm_w/t);
+	      }
+
+	    H_(m*j + j) = cs_(j)*a + sn_(j)*norm_w;
+	    H_(m*(j+1) + j) = T(0);
+	    g_(j+1) = -conjugate(sn_(j))*g_(j);
+	    g_(j) = cs_(j)*g_(j);
+
+	    res = abs(g_(j+1));
+	    j++;
+	    nb_iter_++;
+	    if (nb_iter_%10 == 0)
+	      cout << "Residu at iteration " << nb_iter_ << " = " << res/norm_b << endl;
+
+	    // convergence ou espace de Krylov invariant
+	    if ((res/norm_b <= epsilon) || (norm_w == 0))
+	      break;
+
+	    V_(j) = w_;
+	    V_(j) *= T(1.0/norm_w);
+	  }
+
+	// resolution de H y = g (y stocke dans g)
+	for (int i = j-1; i >= 0; i--)
+	  {
+	    for (int k = i+1; k < j; k++)
+	      g_(i) -= H_(m*i + k)*g_(k);
+
+	    g_(i) /= H_(m*i + i);
+	  }
+
+	// x = x + M^{-1} V y
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  {
+	    T val(0);
+	    for (int k = 0; k < j; k++)
+	      val += g_(k)*V_(k)(i);
+
+	    w_(i) = val;
+	  }
+
+	// la convergence est verifiee sur le vrai residu au debut du cycle suivant
+	prec.Solve(w_, z_);
+	Add(T(1), z_, x);
+      }
+  }
+
+
+  //! Resout A x = b par GMRES(restart) (l'espace de travail est alloue a chaque appel)
+  template<class T>
+  void Gmres(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+	     VirtualPreconditioner<T>& prec, int restart,
+	     double epsilon, int nb_iter_max)
+  {
+    GmresSolver<T> solver;
+    solver.SetRestart(restart);
+    solver.Solve(A, x, b, prec, epsilon, nb_iter_max);
+  }
+
+}
+
+#define LINALG_FILE_GMRES_CXX
+#endif
@@ -0,0 +1,57 @@
+#ifndef LINALG_FILE_GMRES_HXX
+
+namespace linalg
+{
+
+  //! Methode GMRES(m) avec espace de travail prealloue
+  /*!
+    Les vecteurs de Krylov et la matrice de Hessenberg sont conserves entre
+    deux appels a Solve, si bien qu'aucune allocation n'est faite lorsque la
+    taille du systeme et le redemarrage ne changent pas.
+   */
+  template<class T>
+  class GmresSolver
+  {
+  protected:
+    //! nombre d'iterations avant redemarrage
+    int restart_;
+    //! base de Krylov (restart_+1 vecteurs)
+    Vector<Vector<T> > V_;
+    //! matrice de Hessenberg ((restart_+1) x restart_, stockee par lignes)
+    Vector<T> H_;
+    //! rotations de Givens et second membre du probleme aux moindres carres
+    Vector<T> cs_, sn_, g_;
+    //! produits scalaires de l'orthogonalisation
+    Vector<T> h_, h2_;
+    //! produits scalaires partiels de chaque thread (restart_+1 par thread)
+    Vector<T> h_thread_;
+    //! vecteurs de travail
+    Vector<T> w_, z_;
+    //! nombre d'iterations effectuees lors du dernier appel a Solve
+    int nb_iter_;
+
+    void Reallocate(int n);
+    void Orthogonalize(int j);
+
+  public:
+    GmresSolver();
+
+    void SetRestart(int m);
+    int GetNbIterations() const;
+
+    void Solve(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+	       VirtualPreconditioner<T>& prec, double epsilon = 1e-6,
+	       int nb_iter_max = 1000);
+
+  };
+
+
+  template<class T>
+  void Gmres(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+	     VirtualPreconditioner<T>& prec, int restart = 30,
+	     double epsilon = 1e-6, int nb_iter_max = 1000);
+
+}
+
+#define LINALG_FILE_GMRES_HXX
+#endif
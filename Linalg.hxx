@@ -6,6 +6,12 @@
 #include <string>
 #include <cstring>
 #include <exception>
+#include <algorithm>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //! To display a variable (with its name)
 #ifndef DISP
@@ -14,13 +20,28 @@
 
 #include "Allocator.cxx"
 #include "Vector.cxx"
+#include "DenseSolve.cxx"
 #include "SparseVector.cxx"
 #include "SparseMatrix.cxx"
+#include "Ordering.cxx"
+#include "TriangularSolve.cxx"
 #include "TinyVector.cxx"
 #include "CoCg.cxx"
-#include "CommonOutput.cxx"
+#include "Gmres.cxx"
+#include "BiCgStab.cxx"
+#include "RecyclingCg.cxx"
+#include "PrecondSsor.cxx"
+#include "PrecondIlu.cxx"
+#include "PrecondBlockJacobi.cxx"
+#include "PrecondChebyshev.cxx"
+#include "PrecondSpai.cxx"
 
-//#include "SolveMumps.cxx"
+#ifdef LINALG_WITH_MUMPS
+#include "SolveMumps.cxx"
+#endif
+
+#include "PrecondAmg.cxx"
+#include "CommonOutput.cxx"
 
 namespace linalg
 {
@@ -0,0 +1,428 @@
+#ifndef LINALG_FILE_ORDERING_CXX
+
+#include "Ordering.hxx"
+
+namespace linalg
+{
+
+  //! Construit le graphe d'adjacence de la matrice (format CSR)
+  /*!
+    \param[in] A matrice carree
+    \param[out] ptr les voisins du sommet i sont ind(ptr(i)), ..., ind(ptr(i+1)-1)
+    \param[out] ind numeros des voisins
+    Le graphe est celui de la structure de A + A^T, sans la diagonale.
+   */
+  template<class T>
+  void GetAdjacencyGraph(const SparseMatrix<T>& A, Vector<int>& ptr, Vector<int>& ind)
+  {
+    int n = A.GetM();
+    SparseMatrix<T> At, S;
+    A.Transpose(At);
+    AddSymbolic(A, At, S);
+    At.Clear();
+
+    ptr.Reallocate(n+1);
+    ptr(0) = 0;
+    for (int i = 0; i < n; i++)
+      {
+	int nb = S.GetRowSize(i);
+	if (S.FindIndex(i, i) >= 0)
+	  nb--;
+
+	ptr(i+1) = ptr(i) + nb;
+      }
+
+    ind.Reallocate(ptr(n));
+    for (int i = 0; i < n; i++)
+      {
+	int nb = ptr(i);
+	for (int j = 0; j < S.GetRowSize(i); j++)
+	  if (S.Index(i, j) != i)
+	    ind(nb++) = S.Index(i, j);
+      }
+  }
+
+
+  //! Parcours en largeur du sous-graphe des sommets k tels que label(k) = id
+  /*!
+    \param[in] root sommet de depart
+    \param[inout] mark les sommets visites sont marques avec stamp
+    \param[out] order sommets atteints, niveau par niveau
+    \param[out] level_ptr le niveau k est order(level_ptr(k)), ..., order(level_ptr(k+1)-1)
+    \return nombre de niveaux
+    order et level_ptr doivent etre alloues avec une taille suffisante
+   */
+  inline int GetLevelStructure(const Vector<int>& ptr, const Vector<int>& ind,
+			       const Vector<int>& label, int id, int root,
+			       Vector<int>& mark, int stamp,
+			       Vector<int>& order, Vector<int>& level_ptr)
+  {
+    int nb = 0, nb_levels = 0;
+    order(nb++) = root;
+    mark(root) = stamp;
+    level_ptr(0) = 0;
+    int first = 0;
+    while (first < nb)
+      {
+	int last = nb;
+	for (int k = first; k < last; k++)
+	  {
+	    int i = order(k);
+	    for (int j = ptr(i); j < ptr(i+1); j++)
+	      {
+		int node = ind(j);
+		if ((label(node) == id) && (mark(node) != stamp))
+		  {
+		    mark(node) = stamp;
+		    order(nb++) = node;
+		  }
+	      }
+	  }
+
+	nb_levels++;
+	level_ptr(nb_levels) = last;
+	first = last;
+      }
+
+    return nb_levels;
+  }
+
+
+  //! Recherche d'un sommet pseudo-peripherique (algorithme de George-Liu)
+  /*!
+    En sortie, order et level_ptr contiennent la structure en niveaux
+    issue du sommet renvoye, dont le nombre de niveaux est nb_levels
+   */
+  inline int FindPseudoPeripheralNode(const Vector<int>& ptr, const Vector<int>& ind,
+				      const Vector<int>& label, int id, int start,
+				      Vector<int>& mark, int& stamp,
+				      Vector<int>& order, Vector<int>& level_ptr,
+				      int& nb_levels)
+  {
+    int root = start;
+    nb_levels = GetLevelStructure(ptr, ind, label, id, root, mark, ++stamp,
+				  order, level_ptr);
+    while (true)
+      {
+	// sommet de degre minimal sur le dernier niveau
+	int x = order(level_ptr(nb_levels-1));
+	for (int k = level_ptr(nb_levels-1); k < level_ptr(nb_levels); k++)
+	  if (ptr(order(k)+1) - ptr(order(k)) < ptr(x+1) - ptr(x))
+	    x = order(k);
+
+	int nb_levels_x = GetLevelStructure(ptr, ind, label, id, x, mark, ++stamp,
+					    order, level_ptr);
+	if (nb_levels_x <= nb_levels)
+	  break;
+
+	root = x;
+	nb_levels = nb_levels_x;
+      }
+
+    // on reconstruit la structure en niveaux issue de root
+    nb_levels = GetLevelStructure(ptr, ind, label, id, root, mark, ++stamp,
+				  order, level_ptr);
+    return root;
+  }
+
+
+  //! Calcule la renumerotation de Cuthill-McKee inverse (reduction de largeur de bande)
+  /*!
+    \param[in] A matrice carree
+    \param[out] perm nouvelle numerotation : l'inconnue i de la matrice
+    renumerotee est l'inconnue perm(i) de la matrice initiale
+   */
+  template<class T>
+  void FindReverseCuthillMcKeeOrdering(const SparseMatrix<T>& A, Vector<int>& perm)
+  {
+    Vector<int> ptr, ind;
+    GetAdjacencyGraph(A, ptr, ind);
+
+    int n = A.GetM();
+    // label(i) = 0 pour les sommets non encore numerotes
+    Vector<int> label(n), mark(n), order(n), level_ptr(n+1);
+    label.Zero();
+    mark.Zero();
+    int stamp = 0;
+
+    perm.Reallocate(n);
+    int nb = 0;
+    for (int i = 0; i < n; i++)
+      if (label(i) == 0)
+	{
+	  // nouvelle composante connexe
+	  int nb_levels;
+	  int root = FindPseudoPeripheralNode(ptr, ind, label, 0, i, mark, stamp,
+					      order, level_ptr, nb_levels);
+
+	  // parcours de Cuthill-McKee : voisins ajoutes par degre croissant
+	  int first = nb;
+	  perm(nb++) = root;
+	  label(root) = 1;
+	  while (first < nb)
+	    {
+	      int node = perm(first++);
+	      int nb_old = nb;
+	      for (int j = ptr(node); j < ptr(node+1); j++)
+		if (label(ind(j)) == 0)
+		  {
+		    label(ind(j)) = 1;
+		    perm(nb++) = ind(j);
+		  }
+
+	      sort(perm.GetData() + nb_old, perm.GetData() + nb,
+		   [&ptr](int a, int b) { return ptr(a+1) - ptr(a) < ptr(b+1) - ptr(b); });
+	    }
+	}
+
+    // ordre inverse
+    for (int i = 0; i < n/2; i++)
+      swap(perm(i), perm(n-1-i));
+  }
+
+
+  //! Calcule une renumerotation par dissection emboitee
+  /*!
+    \param[in] A matrice carree
+    \param[out] perm nouvelle numerotation : l'inconnue i de la matrice
+    renumerotee est l'inconnue perm(i) de la matrice initiale
+    \param[in] min_size les sous-graphes plus petits ne sont plus decoupes
+    Chaque sous-graphe est coupe en deux par un separateur pris au milieu
+    de la structure en niveaux issue d'un sommet pseudo-peripherique.
+    Les deux parties sont numerotees recursivement, puis le separateur.
+   */
+  template<class T>
+  void FindNestedDissectionOrdering(const SparseMatrix<T>& A, Vector<int>& perm,
+				    int min_size)
+  {
+    Vector<int> ptr, ind;
+    GetAdjacencyGraph(A, ptr, ind);
+
+    int n = A.GetM();
+    Vector<int> label(n), mark(n), order(n), level_ptr(n+1), level(n), work(n);
+    label.Zero();
+    mark.Zero();
+    int stamp = 0, nb_id = 1;
+
+    // les sommets d'un sous-graphe sont stockes dans perm, a leurs positions
+    // finales : perm(start), ..., perm(start+size-1)
+    perm.Reallocate(n);
+    for (int i = 0; i < n; i++)
+      perm(i) = i;
+
+    // pile des sous-graphes a traiter : numero, premiere position et taille
+    Vector<int> stack_id, stack_start, stack_size;
+    stack_id.PushBack(0);
+    stack_start.PushBack(0);
+    stack_size.PushBack(n);
+    while (stack_id.GetM() > 0)
+      {
+	int nb_stack = stack_id.GetM() - 1;
+	int id = stack_id(nb_stack), start = stack_start(nb_stack);
+	int size = stack_size(nb_stack);
+	stack_id.Resize(nb_stack);
+	stack_start.Resize(nb_stack);
+	stack_size.Resize(nb_stack);
+
+	// les petits sous-graphes gardent leur ordre
+	if (size <= min_size)
+	  continue;
+
+	int nb_levels;
+	FindPseudoPeripheralNode(ptr, ind, label, id, perm(start), mark, stamp,
+				 order, level_ptr, nb_levels);
+	int nb_reached = level_ptr(nb_levels);
+	if ((nb_reached == size) && (nb_levels < 3))
+	  continue;
+
+	// les sommets de la premiere partie sont places au debut de work,
+	// ceux de la seconde partie (stockes temporairement dans order)
+	// a la suite et le separateur a la fin
+	int nb1 = 0, nb2 = 0, nb_sep = 0;
+	if (nb_reached < size)
+	  {
+	    // sous-graphe non connexe : la composante atteinte et le reste
+	    for (int k = start; k < start+size; k++)
+	      if (mark(perm(k)) == stamp)
+		work(start + nb1++) = perm(k);
+	      else
+		order(nb2++) = perm(k);
+	  }
+	else
+	  {
+	    // niveau median
+	    int m = 0;
+	    while (level_ptr(m+1) <= size/2)
+	      m++;
+
+	    m = max(1, min(m, nb_levels-2));
+	    for (int l = 0; l < nb_levels; l++)
+	      for (int k = level_ptr(l); k < level_ptr(l+1); k++)
+		level(order(k)) = l;
+
+	    // order n'est plus utile, on s'en sert pour stocker la seconde partie
+
+	    // seuls les sommets du niveau m voisins du niveau m+1 sont dans le separateur
+	    for (int k = start; k < start+size; k++)
+	      {
+		int i = perm(k);
+		bool sep = false;
+		if (level(i) == m)
+		  for (int j = ptr(i); j < ptr(i+1); j++)
+		    if ((label(ind(j)) == id) && (level(ind(j)) == m+1))
+		      sep = true;
+
+		if (sep)
+		  work(start + size - 1 - nb_sep++) = i;
+		else if (level(i) <= m)
+		  work(start + nb1++) = i;
+		else
+		  order(nb2++) = i;
+	      }
+	  }
+
+	for (int k = 0; k < nb2; k++)
+	  work(start + nb1 + k) = order(k);
+
+	int id1 = nb_id++, id2 = nb_id++;
+	for (int k = start; k < start+size; k++)
+	  {
+	    perm(k) = work(k);
+	    if (k < start + nb1)
+	      label(perm(k)) = id1;
+	    else if (k < start + nb1 + nb2)
+	      label(perm(k)) = id2;
+	    else
+	      label(perm(k)) = -1;
+	  }
+
+	stack_id.PushBack(id1);
+	stack_start.PushBack(start);
+	stack_size.PushBack(nb1);
+
+	stack_id.PushBack(id2);
+	stack_start.PushBack(start + nb1);
+	stack_size.PushBack(nb2);
+      }
+  }
+
+
+  //! Coloriage glouton du graphe de la matrice
+  /*!
+    \param[in] A matrice carree
+    \param[out] color couleur de chaque inconnue
+    \return nombre de couleurs
+    Deux inconnues couplees par A (A(i, j) ou A(j, i) non nul) ont des couleurs
+    differentes, les lignes d'une meme couleur peuvent donc etre traitees
+    independamment (Gauss-Seidel ou SSOR multicouleur).
+   */
+  template<class T>
+  int FindGreedyColoring(const SparseMatrix<T>& A, Vector<int>& color)
+  {
+    Vector<int> ptr, ind;
+    GetAdjacencyGraph(A, ptr, ind);
+
+    int n = A.GetM(), nb_colors = 0;
+    color.Reallocate(n);
+    color.Fill(-1);
+
+    // used(c) = i si la couleur c est deja prise par un voisin de i
+    Vector<int> used(n+1);
+    used.Fill(-1);
+    for (int i = 0; i < n; i++)
+      {
+	for (int j = ptr(i); j < ptr(i+1); j++)
+	  if (color(ind(j)) >= 0)
+	    used(color(ind(j))) = i;
+
+	int c = 0;
+	while (used(c) == i)
+	  c++;
+
+	color(i) = c;
+	nb_colors = max(nb_colors, c+1);
+      }
+
+    return nb_colors;
+  }
+
+
+  //! Permutation symetrique de la matrice : A devient A(perm, perm)
+  /*!
+    En sortie, l'element (i, j) de A est l'element (perm(i), perm(j))
+    de la matrice initiale. Les lignes restent triees par numero de colonne.
+   */
+  template<class T>
+  void ApplyPermutation(SparseMatrix<T>& A, const Vector<int>& perm)
+  {
+    int n = A.GetM();
+    Vector<int> inv_perm(n);
+    for (int i = 0; i < n; i++)
+      inv_perm(perm(i)) = i;
+
+    // B n'a pas de coloriage, ses lignes sont redimensionnees en parallele
+    SparseMatrix<T> B(n, n);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < n; i++)
+      {
+	int i_old = perm(i);
+	int size = A.GetRowSize(i_old);
+	Vector<int> order(size);
+	for (int k = 0; k < size; k++)
+	  order(k) = k;
+
+	sort(order.GetData(), order.GetData() + size,
+	     [&](int a, int b)
+	     { return inv_perm(A.Index(i_old, a)) < inv_perm(A.Index(i_old, b)); });
+
+	B.ResizeRow(i, size);
+	for (int k = 0; k < size; k++)
+	  {
+	    B.Index(i, k) = inv_perm(A.Index(i_old, order(k)));
+	    B.Value(i, k) = A.Value(i_old, order(k));
+	  }
+      }
+
+    // la structure permutee reste figee si celle de A l'etait
+    bool frozen = A.IsPatternFrozen();
+    A = B;
+    if (frozen)
+      A.FreezePattern();
+  }
+
+
+  //! Permutation symetrique inverse : A(perm, perm) devient A
+  template<class T>
+  void ApplyInversePermutation(SparseMatrix<T>& A, const Vector<int>& perm)
+  {
+    Vector<int> inv_perm(perm.GetM());
+    for (int i = 0; i < perm.GetM(); i++)
+      inv_perm(perm(i)) = i;
+
+    ApplyPermutation(A, inv_perm);
+  }
+
+
+  //! Permutation du vecteur : x devient x(perm)
+  template<class T>
+  void ApplyPermutation(Vector<T>& x, const Vector<int>& perm)
+  {
+    Vector<T> y(x);
+    for (int i = 0; i < x.GetM(); i++)
+      x(i) = y(perm(i));
+  }
+
+
+  //! Permutation inverse du vecteur : x(perm) devient x
+  template<class T>
+  void ApplyInversePermutation(Vector<T>& x, const Vector<int>& perm)
+  {
+    Vector<T> y(x);
+    for (int i = 0; i < x.GetM(); i++)
+      x(perm(i)) = y(i);
+  }
+
+}
+
+#define LINALG_FILE_ORDERING_CXX
+#endif
@@ -0,0 +1,34 @@
+#ifndef LINALG_FILE_ORDERING_HXX
+
+namespace linalg
+{
+
+  template<class T>
+  void GetAdjacencyGraph(const SparseMatrix<T>& A, Vector<int>& ptr, Vector<int>& ind);
+
+  template<class T>
+  void FindReverseCuthillMcKeeOrdering(const SparseMatrix<T>& A, Vector<int>& perm);
+
+  template<class T>
+  void FindNestedDissectionOrdering(const SparseMatrix<T>& A, Vector<int>& perm,
+				    int min_size = 64);
+
+  template<class T>
+  int FindGreedyColoring(const SparseMatrix<T>& A, Vector<int>& color);
+
+  template<class T>
+  void ApplyPermutation(SparseMatrix<T>& A, const Vector<int>& perm);
+
+  template<class T>
+  void ApplyInversePermutation(SparseMatrix<T>& A, const Vector<int>& perm);
+
+  template<class T>
+  void ApplyPermutation(Vector<T>& x, const Vector<int>& perm);
+
+  template<class T>
+  void ApplyInversePermutation(Vector<T>& x, const Vector<int>& perm);
+
+}
+
+#define LINALG_FILE_ORDERING_HXX
+#endif
@@ -0,0 +1,501 @@
+#ifndef LINALG_FILE_PRECOND_AMG_CXX
+
+#include "PrecondAmg.hxx"
+
+namespace linalg
+{
+
+  /*********************
+   * AmgPreconditioner *
+   *********************/
+
+
+  //! Constructeur par defaut
+  template<class T>
+  AmgPreconditioner<T>::AmgPreconditioner()
+  {
+    threshold_ = 0.08;
+    coarse_size_ = 500;
+    nb_levels_max_ = 10;
+    type_smoother_ = SMOOTHER_SSOR;
+    nb_smoothing_ = 1;
+    omega_ = 1.0;
+    nb_levels_ = 0;
+    A0_ = NULL;
+    direct_coarse_ = false;
+  }
+
+
+  //! Fixe le seuil de couplage fort
+  /*!
+    i et j sont fortement couples si |a_ij| >= threshold sqrt(|a_ii a_jj|)
+   */
+  template<class T>
+  void AmgPreconditioner<T>::SetThreshold(double threshold)
+  {
+    threshold_ = threshold;
+  }
+
+
+  //! Fixe la taille en dessous de laquelle le systeme est resolu directement
+  template<class T>
+  void AmgPreconditioner<T>::SetCoarseSize(int coarse_size)
+  {
+    coarse_size_ = coarse_size;
+  }
+
+
+  //! Fixe le nombre maximal de niveaux (niveau fin compris)
+  template<class T>
+  void AmgPreconditioner<T>::SetNbLevelsMax(int nb_levels)
+  {
+    nb_levels_max_ = nb_levels;
+  }
+
+
+  //! Choix du lisseur
+  /*!
+    \param[in] type SMOOTHER_JACOBI, SMOOTHER_SSOR, SMOOTHER_MULTICOLOR_SSOR
+    ou SMOOTHER_CHEBYSHEV
+    \param[in] nb_iter nombre d'iterations avant et apres la correction grossiere
+    (degre du polynome pour Chebyshev)
+    \param[in] omega parametre de relaxation (de l'ordre de 2/3 pour Jacobi,
+    inutilise pour Chebyshev)
+   */
+  template<class T>
+  void AmgPreconditioner<T>::SetSmoother(int type, int nb_iter, double omega)
+  {
+    type_smoother_ = type;
+    nb_smoothing_ = nb_iter;
+    omega_ = omega;
+  }
+
+
+  //! Retourne le nombre de niveaux de la hierarchie
+  template<class T>
+  int AmgPreconditioner<T>::GetNbLevels() const
+  {
+    return nb_levels_;
+  }
+
+
+  //! Retourne le nombre d'inconnues du niveau l
+  template<class T>
+  int AmgPreconditioner<T>::GetLevelSize(int l) const
+  {
+    return GetLevelMatrix(l).GetM();
+  }
+
+
+  //! Retourne la matrice du niveau l
+  template<class T>
+  const SparseMatrix<T>& AmgPreconditioner<T>::GetLevelMatrix(int l) const
+  {
+    if (l == 0)
+      return *A0_;
+
+    return A_(l);
+  }
+
+
+  //! Construit la hierarchie de grilles
+  /*!
+    La matrice A n'est pas copiee, elle doit rester valide tant que le
+    preconditionneur est utilise. Avec SMOOTHER_MULTICOLOR_SSOR, le coloriage
+    de A est calcule ici (et stocke dans A) s'il ne l'a pas deja ete.
+   */
+  template<class T>
+  void AmgPreconditioner<T>::Setup(const SparseMatrix<T>& A)
+  {
+    Clear();
+    A0_ = &A;
+
+    A_.Reallocate(nb_levels_max_);
+    P_.Reallocate(nb_levels_max_);
+    R_.Reallocate(nb_levels_max_);
+    invDiag_.Reallocate(nb_levels_max_);
+    b_.Reallocate(nb_levels_max_);
+    x_.Reallocate(nb_levels_max_);
+    res_.Reallocate(nb_levels_max_);
+
+    GetInverseDiagonal(A, invDiag_(0));
+    nb_levels_ = 1;
+    while ((nb_levels_ < nb_levels_max_) && (GetLevelSize(nb_levels_-1) > coarse_size_))
+      {
+	int l = nb_levels_-1, n = GetLevelSize(l);
+	const SparseMatrix<T>& Al = GetLevelMatrix(l);
+
+	Vector<int> aggregate;
+	int nc = FindAggregates(Al, threshold_, aggregate);
+
+	// on arrete si le grossissement ne reduit presque plus la taille
+	if (10*size_t(nc) > 9*size_t(n))
+	  break;
+
+	GetSmoothedProlongator(Al, invDiag_(l), aggregate, nc, P_(l));
+	P_(l).Transpose(R_(l));
+
+	// produit de Galerkin
+	SparseMatrix<T> AP;
+	Al.MltM(P_(l), AP);
+	R_(l).MltM(AP, A_(l+1));
+
+	GetInverseDiagonal(A_(l+1), invDiag_(l+1));
+	nb_levels_++;
+      }
+
+    for (int l = 0; l < nb_levels_; l++)
+      {
+	int n = GetLevelSize(l);
+	b_(l).Reallocate(n);
+	x_(l).Reallocate(n);
+	res_(l).Reallocate(n);
+      }
+
+    // sans MUMPS, une LU dense n'est faite que sur un niveau assez petit
+    int l = nb_levels_-1;
+#ifdef LINALG_WITH_MUMPS
+    direct_coarse_ = true;
+#else
+    direct_coarse_ = (GetLevelSize(l) <= coarse_size_);
+#endif
+
+    if (type_smoother_ == SMOOTHER_MULTICOLOR_SSOR)
+      {
+	// le coloriage est calcule une fois ici, pas pendant les V-cycles
+	int nb_smoothed = direct_coarse_ ? nb_levels_-1 : nb_levels_;
+	for (int k = 0; k < nb_smoothed; k++)
+	  if (GetLevelMatrix(k).GetNbColors() == 0)
+	    GetLevelMatrix(k).ComputeColoring();
+      }
+
+    if (type_smoother_ == SMOOTHER_CHEBYSHEV)
+      {
+	// le lisseur traite le haut du spectre [lambda_max/30, lambda_max]
+	int nb_smoothed = direct_coarse_ ? nb_levels_-1 : nb_levels_;
+	chebyshev_.Reallocate(nb_smoothed);
+	dx_.Reallocate(nb_smoothed);
+	for (int k = 0; k < nb_smoothed; k++)
+	  {
+	    chebyshev_(k).SetParameters(nb_smoothing_, 30.0);
+	    chebyshev_(k).Init(GetLevelMatrix(k), invDiag_(k));
+	    dx_(k).Reallocate(GetLevelSize(k));
+	  }
+      }
+
+    if (!direct_coarse_)
+      return;
+
+    // factorisation du niveau grossier
+#ifdef LINALG_WITH_MUMPS
+    SparseMatrix<T> Ac(GetLevelMatrix(l));
+    mumps_.HideMessages();
+    mumps_.Factorize(Ac, false);
+#else
+    int n = GetLevelSize(l);
+    const SparseMatrix<T>& Ac = GetLevelMatrix(l);
+    coarse_lu_.Reallocate(size_t(n)*n);
+    coarse_lu_.Fill(T(0));
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < Ac.GetRowSize(i); j++)
+	coarse_lu_(size_t(n)*i + Ac.Index(i, j)) = Ac.Value(i, j);
+
+    GetLU(n, coarse_lu_, coarse_pivot_);
+#endif
+  }
+
+
+  //! Libere la hierarchie
+  template<class T>
+  void AmgPreconditioner<T>::Clear()
+  {
+    nb_levels_ = 0;
+    A0_ = NULL;
+    A_.Clear();
+    P_.Clear();
+    R_.Clear();
+    invDiag_.Clear();
+    b_.Clear();
+    x_.Clear();
+    res_.Clear();
+    chebyshev_.Clear();
+    dx_.Clear();
+    direct_coarse_ = false;
+#ifdef LINALG_WITH_MUMPS
+    mumps_.Clear();
+#else
+    coarse_lu_.Clear();
+    coarse_pivot_.Clear();
+#endif
+  }
+
+
+  //! Calcule le residu res_(l) = b_(l) - A x_(l) du niveau l
+  template<class T>
+  void AmgPreconditioner<T>::ComputeResidual(int l)
+  {
+    const SparseMatrix<T>& A = GetLevelMatrix(l);
+    const Vector<T>& b = b_(l);
+    const Vector<T>& x = x_(l);
+    Vector<T>& res = res_(l);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < A.GetM(); i++)
+      {
+	T val = b(i);
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  val -= A.Value(i, j)*x(A.Index(i, j));
+
+	res(i) = val;
+      }
+  }
+
+
+  //! Applique le lisseur au niveau l (x_(l) est modifie, b_(l) est le second membre)
+  template<class T>
+  void AmgPreconditioner<T>::Smooth(int l)
+  {
+    if (type_smoother_ == SMOOTHER_CHEBYSHEV)
+      {
+	// x = x + p(D^{-1} A) D^{-1} (b - A x)
+	ComputeResidual(l);
+	chebyshev_(l).Solve(res_(l), dx_(l));
+	Add(T(1), dx_(l), x_(l));
+	return;
+      }
+
+    const SparseMatrix<T>& A = GetLevelMatrix(l);
+    const Vector<T>& invDiag = invDiag_(l);
+    const Vector<T>& b = b_(l);
+    Vector<T>& x = x_(l);
+    Vector<T>& res = res_(l);
+    int n = A.GetM();
+    for (int k = 0; k < nb_smoothing_; k++)
+      {
+	if (type_smoother_ == SMOOTHER_JACOBI)
+	  {
+#pragma omp parallel for schedule(static)
+	    for (int i = 0; i < n; i++)
+	      {
+		T val = b(i);
+		for (int j = 0; j < A.GetRowSize(i); j++)
+		  val -= A.Value(i, j)*x(A.Index(i, j));
+
+		res(i) = omega_*val*invDiag(i);
+	      }
+
+#pragma omp parallel for schedule(static)
+	    for (int i = 0; i < n; i++)
+	      x(i) += res(i);
+	  }
+	else if (type_smoother_ == SMOOTHER_MULTICOLOR_SSOR)
+	  A.ApplyMulticolorSsor(b, invDiag, x, omega_);
+	else
+	  A.ApplySsor(b, invDiag, x, omega_);
+      }
+  }
+
+
+  //! Effectue un V-cycle a partir du niveau l (x_(l) est calcule a partir de b_(l))
+  template<class T>
+  void AmgPreconditioner<T>::Cycle(int l)
+  {
+    Vector<T>& x = x_(l);
+    if ((l == nb_levels_-1) && !direct_coarse_)
+      {
+	// niveau grossier trop gros pour une LU dense : pre et post-lissage
+	x.Fill(T(0));
+	Smooth(l);
+	Smooth(l);
+	return;
+      }
+
+    if (l == nb_levels_-1)
+      {
+	// resolution directe sur la grille grossiere
+	x = b_(l);
+#ifdef LINALG_WITH_MUMPS
+	mumps_.Solve(x);
+#else
+	SolveLU(x.GetM(), coarse_lu_, coarse_pivot_, x);
+#endif
+	return;
+      }
+
+    x.Fill(T(0));
+    Smooth(l);
+
+    // restriction du residu
+    ComputeResidual(l);
+    R_(l).Mlt(res_(l), b_(l+1));
+    Cycle(l+1);
+
+    // correction et post-lissage
+    P_(l).MltAdd(T(1), x_(l+1), x);
+    Smooth(l);
+  }
+
+
+  //! Applique le preconditionneur (un V-cycle) : z = M^{-1} r
+  template<class T>
+  void AmgPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    b_(0) = r;
+    Cycle(0);
+    z = x_(0);
+  }
+
+
+  /*********************
+   * Fonctions annexes *
+   *********************/
+
+
+  //! Regroupe les inconnues fortement couplees en agregats
+  /*!
+    \param[in] A matrice du niveau courant
+    \param[in] threshold i et j sont fortement couples si
+    |a_ij| >= threshold sqrt(|a_ii a_jj|)
+    \param[out] aggregate numero d'agregat de chaque inconnue
+    \return nombre d'agregats
+    On forme d'abord des agregats disjoints (une inconnue et tous ses
+    voisins forts), les inconnues restantes sont rattachees a un agregat
+    voisin, puis celles qui n'ont aucun voisin agrege forment de nouveaux
+    agregats.
+   */
+  template<class T>
+  int FindAggregates(const SparseMatrix<T>& A, double threshold, Vector<int>& aggregate)
+  {
+    int n = A.GetM();
+    Vector<double> diag(n);
+    diag.Fill(0.0);
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < A.GetRowSize(i); j++)
+	if (A.Index(i, j) == i)
+	  diag(i) = abs(A.Value(i, j));
+
+    // graphe des couplages forts
+    Vector<int> ptr(n+1), ind;
+    ptr(0) = 0;
+    for (int i = 0; i < n; i++)
+      {
+	ptr(i+1) = ptr(i);
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if (A.Index(i, j) != i)
+	    ptr(i+1)++;
+      }
+
+    ind.Reallocate(ptr(n));
+    int nb = 0;
+    double eps2 = threshold*threshold;
+    for (int i = 0; i < n; i++)
+      {
+	ptr(i) = nb;
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  {
+	    int k = A.Index(i, j);
+	    double val = abs(A.Value(i, j));
+	    if ((k != i) && (val*val >= eps2*diag(i)*diag(k)))
+	      ind(nb++) = k;
+	  }
+      }
+
+    ptr(n) = nb;
+
+    // phase 1 : agregats formes d'une inconnue et de tous ses voisins forts
+    aggregate.Reallocate(n);
+    aggregate.Fill(-1);
+    int nb_aggregates = 0;
+    for (int i = 0; i < n; i++)
+      {
+	if ((aggregate(i) >= 0) || (ptr(i+1) == ptr(i)))
+	  continue;
+
+	bool free_nodes = true;
+	for (int j = ptr(i); j < ptr(i+1); j++)
+	  if (aggregate(ind(j)) >= 0)
+	    free_nodes = false;
+
+	if (free_nodes)
+	  {
+	    aggregate(i) = nb_aggregates;
+	    for (int j = ptr(i); j < ptr(i+1); j++)
+	      aggregate(ind(j)) = nb_aggregates;
+
+	    nb_aggregates++;
+	  }
+      }
+
+    // phase 2 : rattachement a un agregat de la phase 1
+    Vector<int> aggregate1(aggregate);
+    for (int i = 0; i < n; i++)
+      if (aggregate(i) < 0)
+	for (int j = ptr(i); j < ptr(i+1); j++)
+	  if (aggregate1(ind(j)) >= 0)
+	    {
+	      aggregate(i) = aggregate1(ind(j));
+	      break;
+	    }
+
+    // phase 3 : nouveaux agregats avec les voisins restants
+    for (int i = 0; i < n; i++)
+      if (aggregate(i) < 0)
+	{
+	  aggregate(i) = nb_aggregates;
+	  for (int j = ptr(i); j < ptr(i+1); j++)
+	    if (aggregate(ind(j)) < 0)
+	      aggregate(ind(j)) = nb_aggregates;
+
+	  nb_aggregates++;
+	}
+
+    return nb_aggregates;
+  }
+
+
+  //! Calcule le prolongateur lisse P = (I - w D^{-1} A) P0
+  /*!
+    P0 est le prolongateur constant par agregat (P0(i, aggregate(i)) = 1).
+    Le parametre w = 4/(3 rho) utilise une majoration du rayon spectral
+    rho de D^{-1} A par les disques de Gershgorin.
+   */
+  template<class T>
+  void GetSmoothedProlongator(const SparseMatrix<T>& A, const Vector<T>& invDiag,
+			      const Vector<int>& aggregate, int nb_aggregates,
+			      SparseMatrix<T>& P)
+  {
+    int n = A.GetM();
+    double rho = 0;
+    for (int i = 0; i < n; i++)
+      {
+	double sum = 0;
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  sum += abs(A.Value(i, j));
+
+	rho = max(rho, sum*abs(invDiag(i)));
+      }
+
+    SparseMatrix<T> P0(n, nb_aggregates);
+    for (int i = 0; i < n; i++)
+      {
+	P0.ReallocateRow(i, 1);
+	P0.Index(i, 0) = aggregate(i);
+	P0.Value(i, 0) = T(1);
+      }
+
+    // A P0 a la structure de P (la diagonale de A donne la colonne aggregate(i))
+    A.MltM(P0, P);
+    T omega = T(4.0/(3.0*rho));
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < P.GetRowSize(i); j++)
+	{
+	  P.Value(i, j) *= -omega*invDiag(i);
+	  if (P.Index(i, j) == aggregate(i))
+	    P.Value(i, j) += T(1);
+	}
+  }
+
+}
+
+#define LINALG_FILE_PRECOND_AMG_CXX
+#endif
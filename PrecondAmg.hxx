@@ -0,0 +1,98 @@
+#ifndef LINALG_FILE_PRECOND_AMG_HXX
+
+namespace linalg
+{
+
+  //! Preconditionneur multigrille algebrique par agregation lissee (SA-AMG)
+  /*!
+    Les inconnues fortement couplees sont regroupees en agregats, le
+    prolongateur constant par agregat est lisse par une iteration de Jacobi,
+    et les matrices grossieres sont obtenues par le produit de Galerkin
+    P^T A P (sans conjugaison, pour rester compatible avec COCG).
+    La hierarchie est construite une fois par Setup, chaque appel a Solve
+    effectue un V-cycle a partir de z = 0. Le niveau le plus grossier est
+    resolu par MUMPS si LINALG_WITH_MUMPS est defini, par une factorisation
+    LU dense sinon. La LU dense n'est calculee que si le niveau grossier a
+    au plus coarse_size_ inconnues (le grossissement peut s'arreter avant),
+    sinon ce niveau est seulement lisse.
+   */
+  template<class T>
+  class AmgPreconditioner : public VirtualPreconditioner<T>
+  {
+  public:
+    //! lisseurs disponibles
+    enum {SMOOTHER_JACOBI, SMOOTHER_SSOR, SMOOTHER_MULTICOLOR_SSOR, SMOOTHER_CHEBYSHEV};
+
+  protected:
+    //! seuil de couplage fort
+    double threshold_;
+    //! taille en dessous de laquelle on arrete le grossissement
+    int coarse_size_;
+    //! nombre maximal de niveaux
+    int nb_levels_max_;
+    //! type de lisseur, nombre d'iterations et parametre de relaxation
+    int type_smoother_, nb_smoothing_;
+    double omega_;
+
+    //! nombre de niveaux construits
+    int nb_levels_;
+    //! matrice du niveau le plus fin (non copiee)
+    const SparseMatrix<T>* A0_;
+    //! matrices des niveaux grossiers (A_(0) n'est pas utilisee)
+    Vector<SparseMatrix<T> > A_;
+    //! P_(l) prolonge du niveau l+1 au niveau l, R_(l) = P_(l)^T
+    Vector<SparseMatrix<T> > P_, R_;
+    //! inverse de la diagonale de chaque niveau
+    Vector<Vector<T> > invDiag_;
+    //! second membre, solution et residu de chaque niveau
+    Vector<Vector<T> > b_, x_, res_;
+    //! lisseurs de Chebyshev de chaque niveau et correction associee
+    Vector<ChebyshevPreconditioner<T> > chebyshev_;
+    Vector<Vector<T> > dx_;
+    //! true si le niveau le plus grossier est resolu directement
+    bool direct_coarse_;
+
+    //! factorisation du niveau le plus grossier
+#ifdef LINALG_WITH_MUMPS
+    MatrixMumps<T> mumps_;
+#else
+    Vector<T> coarse_lu_;
+    Vector<int> coarse_pivot_;
+#endif
+
+    const SparseMatrix<T>& GetLevelMatrix(int l) const;
+    void ComputeResidual(int l);
+    void Smooth(int l);
+    void Cycle(int l);
+
+  public:
+    AmgPreconditioner();
+
+    void SetThreshold(double threshold);
+    void SetCoarseSize(int coarse_size);
+    void SetNbLevelsMax(int nb_levels);
+    void SetSmoother(int type, int nb_iter = 1, double omega = 1.0);
+
+    int GetNbLevels() const;
+    int GetLevelSize(int l) const;
+
+    void Setup(const SparseMatrix<T>& A);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+
+  template<class T>
+  int FindAggregates(const SparseMatrix<T>& A, double threshold, Vector<int>& aggregate);
+
+  template<class T>
+  void GetSmoothedProlongator(const SparseMatrix<T>& A, const Vector<T>& invDiag,
+			      const Vector<int>& aggregate, int nb_aggregates,
+			      SparseMatrix<T>& P);
+
+}
+
+#define LINALG_FILE_PRECOND_AMG_HXX
+#endif
@@ -0,0 +1,203 @@
+#ifndef LINALG_FILE_PRECOND_BLOCK_JACOBI_CXX
+
+#include "PrecondBlockJacobi.hxx"
+
+namespace linalg
+{
+
+  /*****************************
+   * BlockJacobiPreconditioner *
+   *****************************/
+
+
+  //! Extrait et inverse les blocs diagonaux de A
+  /*!
+    Le nombre de lignes de A doit etre un multiple de p. Chaque bloc
+    est inverse par la methode de Gauss-Jordan avec pivot partiel.
+   */
+  template<class T, int p>
+  void BlockJacobiPreconditioner<T, p>::Factorize(const SparseMatrix<T>& A)
+  {
+    if (A.GetM()%p != 0)
+      {
+	cout << "la taille de la matrice doit etre un multiple de " << p << endl;
+	abort();
+      }
+
+    int nb_blocks = A.GetM()/p;
+    inv_.Reallocate(A.GetM());
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < nb_blocks; k++)
+      {
+	// extraction du bloc diagonal
+	TinyVector<T, p> block[p], inv[p];
+	for (int i = 0; i < p; i++)
+	  {
+	    int row = p*k + i;
+	    block[i].Zero();
+	    inv[i].Zero();
+	    inv[i](i) = T(1);
+	    for (int j = 0; j < A.GetRowSize(row); j++)
+	      if ((A.Index(row, j) >= p*k) && (A.Index(row, j) < p*k + p))
+		block[i](A.Index(row, j) - p*k) = A.Value(row, j);
+	  }
+
+	// Gauss-Jordan
+	for (int c = 0; c < p; c++)
+	  {
+	    int r = c;
+	    for (int i = c+1; i < p; i++)
+	      if (abs(block[i](c)) > abs(block[r](c)))
+		r = i;
+
+	    if (block[r](c) == T(0))
+	      {
+		cout << "le bloc diagonal " << k << " est singulier" << endl;
+		abort();
+	      }
+
+	    if (r != c)
+	      {
+		swap(block[r], block[c]);
+		swap(inv[r], inv[c]);
+	      }
+
+	    T coef = T(1) / block[c](c);
+	    block[c] *= coef;
+	    inv[c] *= coef;
+	    for (int i = 0; i < p; i++)
+	      if (i != c)
+		{
+		  coef = block[i](c);
+		  block[i] -= coef*block[c];
+		  inv[i] -= coef*inv[c];
+		}
+	  }
+
+	for (int i = 0; i < p; i++)
+	  inv_(p*k + i) = inv[i];
+      }
+  }
+
+
+  //! Efface les inverses des blocs
+  template<class T, int p>
+  void BlockJacobiPreconditioner<T, p>::Clear()
+  {
+    inv_.Clear();
+  }
+
+
+  //! Applique le preconditionneur z = D^{-1} r (D matrice diagonale par blocs)
+  template<class T, int p>
+  void BlockJacobiPreconditioner<T, p>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    int nb_blocks = r.GetM()/p;
+    z.Reallocate(r.GetM());
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < nb_blocks; k++)
+      {
+	TinyVector<T, p> r_loc;
+	for (int i = 0; i < p; i++)
+	  r_loc(i) = r(p*k + i);
+
+	for (int i = 0; i < p; i++)
+	  z(p*k + i) = DotProd(inv_(p*k + i), r_loc);
+      }
+  }
+
+
+  /*************************************
+   * VariableBlockJacobiPreconditioner *
+   *************************************/
+
+
+  //! Extrait et inverse les blocs diagonaux de A
+  /*!
+    \param[in] A matrice du systeme
+    \param[in] partition numero de bloc de chaque inconnue (compris entre 0
+    et le nombre de blocs - 1), les inconnues d'un bloc n'ont pas besoin
+    d'etre contigues
+   */
+  template<class T>
+  void VariableBlockJacobiPreconditioner<T>::Factorize(const SparseMatrix<T>& A,
+						       const Vector<int>& partition)
+  {
+    int n = A.GetM(), nb_blocks = 0;
+    for (int i = 0; i < n; i++)
+      nb_blocks = max(nb_blocks, partition(i)+1);
+
+    // inconnues de chaque bloc
+    block_ptr_.Reallocate(nb_blocks+1);
+    block_ptr_.Zero();
+    for (int i = 0; i < n; i++)
+      block_ptr_(partition(i)+1)++;
+
+    for (int b = 0; b < nb_blocks; b++)
+      block_ptr_(b+1) += block_ptr_(b);
+
+    block_num_.Reallocate(n);
+    Vector<int> nb(block_ptr_), local(n);
+    for (int i = 0; i < n; i++)
+      {
+	local(i) = nb(partition(i)) - block_ptr_(partition(i));
+	block_num_(nb(partition(i))++) = i;
+      }
+
+    inv_.Reallocate(nb_blocks);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int b = 0; b < nb_blocks; b++)
+      {
+	int size = block_ptr_(b+1) - block_ptr_(b);
+	Vector<T>& inv = inv_(b);
+	inv.Reallocate(size*size);
+	inv.Fill(T(0));
+	for (int k = 0; k < size; k++)
+	  {
+	    int i = block_num_(block_ptr_(b) + k);
+	    for (int j = 0; j < A.GetRowSize(i); j++)
+	      if (partition(A.Index(i, j)) == b)
+		inv(size*k + local(A.Index(i, j))) = A.Value(i, j);
+	  }
+
+	GetInverse(size, inv);
+      }
+  }
+
+
+  //! Efface les inverses des blocs
+  template<class T>
+  void VariableBlockJacobiPreconditioner<T>::Clear()
+  {
+    block_ptr_.Clear();
+    block_num_.Clear();
+    inv_.Clear();
+  }
+
+
+  //! Applique le preconditionneur z = D^{-1} r (D matrice diagonale par blocs)
+  template<class T>
+  void VariableBlockJacobiPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    z.Reallocate(r.GetM());
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int b = 0; b < block_ptr_.GetM()-1; b++)
+      {
+	int size = block_ptr_(b+1) - block_ptr_(b);
+	const int* num = &block_num_.GetData()[block_ptr_(b)];
+	const Vector<T>& inv = inv_(b);
+	for (int k = 0; k < size; k++)
+	  {
+	    T val(0);
+	    for (int l = 0; l < size; l++)
+	      val += inv(size*k + l)*r(num[l]);
+
+	    z(num[k]) = val;
+	  }
+      }
+  }
+
+}
+
+#define LINALG_FILE_PRECOND_BLOCK_JACOBI_CXX
+#endif
@@ -0,0 +1,54 @@
+#ifndef LINALG_FILE_PRECOND_BLOCK_JACOBI_HXX
+
+namespace linalg
+{
+
+  //! Preconditionneur de Jacobi par blocs de taille fixe p
+  /*!
+    Le bloc k regroupe les inconnues p*k, ..., p*k+p-1 (par exemple les p
+    degres de liberte d'un meme noeud). Les blocs diagonaux sont inverses
+    une fois pour toutes, les boucles de taille p etant deroulees a la
+    compilation par les operations de TinyVector.
+   */
+  template<class T, int p>
+  class BlockJacobiPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! la ligne i de l'inverse du bloc k est inv_(p*k + i)
+    Vector<TinyVector<T, p> > inv_;
+
+  public:
+    void Factorize(const SparseMatrix<T>& A);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+
+  //! Preconditionneur de Jacobi par blocs de tailles variables
+  /*!
+    Les blocs sont donnes par une partition des inconnues, les inverses
+    des blocs diagonaux sont stockes sous forme de matrices denses.
+   */
+  template<class T>
+  class VariableBlockJacobiPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! les inconnues du bloc b sont block_num_(block_ptr_(b)), ..., block_num_(block_ptr_(b+1)-1)
+    Vector<int> block_ptr_, block_num_;
+    //! inverse de chaque bloc diagonal (matrice dense stockee par lignes)
+    Vector<Vector<T> > inv_;
+
+  public:
+    void Factorize(const SparseMatrix<T>& A, const Vector<int>& partition);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+}
+
+#define LINALG_FILE_PRECOND_BLOCK_JACOBI_HXX
+#endif
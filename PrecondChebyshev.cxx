@@ -0,0 +1,159 @@
+#ifndef LINALG_FILE_PRECOND_CHEBYSHEV_CXX
+
+#include "PrecondChebyshev.hxx"
+
+namespace linalg
+{
+
+  //! Constructeur par defaut
+  template<class T>
+  ChebyshevPreconditioner<T>::ChebyshevPreconditioner()
+  {
+    A_ = NULL;
+    degree_ = 3;
+    ratio_ = 30.0;
+    nb_iter_power_ = 10;
+    lambda_min_ = 0;
+    lambda_max_ = 0;
+  }
+
+
+  //! Change le degre du polynome et les parametres d'estimation du spectre
+  /*!
+    \param[in] degree degre du polynome (nombre de produits matrice-vecteur par application)
+    \param[in] ratio rapport lambda_max / lambda_min de l'intervalle traite
+    \param[in] nb_iter_power nombre d'iterations de la methode de la puissance
+   */
+  template<class T>
+  void ChebyshevPreconditioner<T>::SetParameters(int degree, double ratio, int nb_iter_power)
+  {
+    degree_ = degree;
+    ratio_ = ratio;
+    nb_iter_power_ = nb_iter_power;
+  }
+
+
+  //! Fixe directement les bornes du spectre (l'estimation n'est alors pas faite par Init)
+  template<class T>
+  void ChebyshevPreconditioner<T>::SetEigenvalueBounds(double lambda_min, double lambda_max)
+  {
+    lambda_min_ = lambda_min;
+    lambda_max_ = lambda_max;
+    nb_iter_power_ = 0;
+  }
+
+
+  //! Initialise le preconditionneur sans mise a l'echelle (D = I)
+  template<class T>
+  void ChebyshevPreconditioner<T>::Init(const VirtualMatrix<T>& A)
+  {
+    Vector<T> invDiag;
+    Init(A, invDiag);
+  }
+
+
+  //! Initialise le preconditionneur et estime la plus grande valeur propre de D^{-1} A
+  /*!
+    La matrice A est conservee par reference, elle doit exister tant que
+    le preconditionneur est utilise. La borne estimee est majoree de 10 %
+    car la methode de la puissance approche lambda_max par valeurs inferieures.
+   */
+  template<class T>
+  void ChebyshevPreconditioner<T>::Init(const VirtualMatrix<T>& A, const Vector<T>& invDiag)
+  {
+    A_ = &A;
+    invDiag_ = invDiag;
+    int n = A.GetM();
+    res_.Reallocate(n);
+    d_.Reallocate(n);
+    if (nb_iter_power_ <= 0)
+      return;
+
+    // methode de la puissance sur D^{-1} A
+    d_.FillRand();
+    double lambda = 0;
+    for (int k = 0; k < nb_iter_power_; k++)
+      {
+	double norm = abs(Norm2(d_));
+	if (norm == 0)
+	  break;
+
+	d_ *= T(1.0/norm);
+	A.Mlt(d_, res_);
+	if (invDiag_.GetM() > 0)
+	  for (int i = 0; i < n; i++)
+	    res_(i) *= invDiag_(i);
+
+	lambda = abs(Norm2(res_));
+	d_ = res_;
+      }
+
+    lambda_max_ = 1.1*lambda;
+    lambda_min_ = lambda_max_ / ratio_;
+  }
+
+
+  //! Retourne la borne inferieure de l'intervalle
+  template<class T>
+  double ChebyshevPreconditioner<T>::GetLambdaMin() const
+  {
+    return lambda_min_;
+  }
+
+
+  //! Retourne la borne superieure de l'intervalle
+  template<class T>
+  double ChebyshevPreconditioner<T>::GetLambdaMax() const
+  {
+    return lambda_max_;
+  }
+
+
+  //! Applique le preconditionneur z = p(D^{-1} A) D^{-1} r
+  /*!
+    On effectue degree iterations de Chebyshev pour A z = r a partir de
+    z = 0. Chaque iteration fait un produit matrice-vecteur puis met a jour
+    la direction d et z dans une seule boucle.
+   */
+  template<class T>
+  void ChebyshevPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    int n = r.GetM();
+    bool scaling = (invDiag_.GetM() > 0);
+    double theta = 0.5*(lambda_max_ + lambda_min_);
+    double delta = 0.5*(lambda_max_ - lambda_min_);
+    double sigma = theta/delta, rho = 1.0/sigma;
+
+    // premiere iteration : z = d = D^{-1} r / theta
+    z.Reallocate(n);
+    T coef = T(1.0/theta);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+      {
+	res_(i) = r(i);
+	d_(i) = scaling ? coef*invDiag_(i)*r(i) : coef*r(i);
+	z(i) = d_(i);
+      }
+
+    for (int k = 1; k < degree_; k++)
+      {
+	// residu res = r - A z
+	A_->MltAdd(T(-1), d_, res_);
+
+	double rho_new = 1.0/(2.0*sigma - rho);
+	T alpha = T(rho_new*rho), beta = T(2.0*rho_new/delta);
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  {
+	    d_(i) = alpha*d_(i) + (scaling ? beta*invDiag_(i)*res_(i) : beta*res_(i));
+	    z(i) += d_(i);
+	  }
+
+	rho = rho_new;
+      }
+  }
+
+}
+
+#define LINALG_FILE_PRECOND_CHEBYSHEV_CXX
+#endif
@@ -0,0 +1,53 @@
+#ifndef LINALG_FILE_PRECOND_CHEBYSHEV_HXX
+
+namespace linalg
+{
+
+  //! Preconditionneur polynomial de Chebyshev
+  /*!
+    z = p(D^{-1} A) D^{-1} r ou p est le polynome de Chebyshev de degre
+    donne sur l'intervalle [lambda_max/ratio, lambda_max]. La valeur propre
+    maximale de D^{-1} A est estimee par la methode de la puissance. Seuls
+    des produits matrice-vecteur et des combinaisons lineaires sont utilises
+    (aucun produit scalaire), le preconditionneur convient donc a toute
+    VirtualMatrix. Si aucune diagonale n'est fournie, D = I.
+   */
+  template<class T>
+  class ChebyshevPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! matrice du systeme lineaire
+    const VirtualMatrix<T>* A_;
+    //! inverse de la diagonale (vide si D = I)
+    Vector<T> invDiag_;
+    //! degre du polynome
+    int degree_;
+    //! lambda_min = lambda_max / ratio_
+    double ratio_;
+    //! nombre d'iterations de la methode de la puissance
+    int nb_iter_power_;
+    //! bornes de l'intervalle
+    double lambda_min_, lambda_max_;
+    //! vecteurs de travail
+    Vector<T> res_, d_;
+
+  public:
+    ChebyshevPreconditioner();
+
+    void SetParameters(int degree, double ratio = 30.0, int nb_iter_power = 10);
+    void SetEigenvalueBounds(double lambda_min, double lambda_max);
+
+    void Init(const VirtualMatrix<T>& A);
+    void Init(const VirtualMatrix<T>& A, const Vector<T>& invDiag);
+
+    double GetLambdaMin() const;
+    double GetLambdaMax() const;
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+}
+
+#define LINALG_FILE_PRECOND_CHEBYSHEV_HXX
+#endif
@@ -0,0 +1,294 @@
+#ifndef LINALG_FILE_PRECOND_ILU_CXX
+
+#include "PrecondIlu.hxx"
+
+namespace linalg
+{
+
+  /*********************
+   * IluPreconditioner *
+   *********************/
+
+
+  //! Calcule la factorisation ILU(0) de A
+  /*!
+    La structure de L + U est celle de A, tous les coefficients diagonaux
+    doivent etre presents. La matrice A peut ensuite etre detruite.
+   */
+  template<class T>
+  void IluPreconditioner<T>::Factorize(const SparseMatrix<T>& A)
+  {
+    int n = A.GetM();
+
+    // copie de A au format CSR
+    Vector<int> ptr(n+1), ind, diag(n);
+    Vector<T> val;
+    ptr(0) = 0;
+    for (int i = 0; i < n; i++)
+      ptr(i+1) = ptr(i) + A.GetRowSize(i);
+
+    ind.Reallocate(ptr(n));
+    val.Reallocate(ptr(n));
+    for (int i = 0; i < n; i++)
+      {
+	diag(i) = -1;
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  {
+	    ind(ptr(i)+j) = A.Index(i, j);
+	    val(ptr(i)+j) = A.Value(i, j);
+	    if (A.Index(i, j) == i)
+	      diag(i) = ptr(i)+j;
+	  }
+
+	if (diag(i) < 0)
+	  {
+	    cout << "le coefficient diagonal " << i << " est absent" << endl;
+	    abort();
+	  }
+      }
+
+    // la ligne i depend des lignes k < i presentes dans sa partie inferieure
+    GetLevelSets(ptr, ind, true, lower_level_ptr_, lower_level_row_);
+
+    // position(t*n + j) : position de la colonne j dans la ligne traitee par le thread t
+    Vector<int> position(size_t(GetNbThreads())*n);
+    position.Fill(-1);
+    invDiag_.Reallocate(n);
+    for (int l = 0; l < lower_level_ptr_.GetM()-1; l++)
+      {
+#pragma omp parallel for schedule(static)
+	for (int p = lower_level_ptr_(l); p < lower_level_ptr_(l+1); p++)
+	  {
+	    int i = lower_level_row_(p);
+	    int* pos = &position.GetData()[size_t(GetThreadNumber())*n];
+	    for (int j = ptr(i); j < ptr(i+1); j++)
+	      pos[ind(j)] = j;
+
+	    // elimination avec les lignes k < i (ordre croissant)
+	    for (int j = ptr(i); j < diag(i); j++)
+	      {
+		int k = ind(j);
+		val(j) *= invDiag_(k);
+		for (int m = diag(k)+1; m < ptr(k+1); m++)
+		  if (pos[ind(m)] >= 0)
+		    val(pos[ind(m)]) -= val(j)*val(m);
+	      }
+
+	    if (val(diag(i)) == T(0))
+	      {
+		cout << "pivot nul sur la ligne " << i << " de ILU(0)" << endl;
+		abort();
+	      }
+
+	    invDiag_(i) = T(1) / val(diag(i));
+	    for (int j = ptr(i); j < ptr(i+1); j++)
+	      pos[ind(j)] = -1;
+	  }
+      }
+
+    // stockage separe de L et U
+    lower_ptr_.Reallocate(n+1);
+    upper_ptr_.Reallocate(n+1);
+    lower_ptr_(0) = 0;
+    upper_ptr_(0) = 0;
+    for (int i = 0; i < n; i++)
+      {
+	lower_ptr_(i+1) = lower_ptr_(i) + diag(i) - ptr(i);
+	upper_ptr_(i+1) = upper_ptr_(i) + ptr(i+1) - diag(i) - 1;
+      }
+
+    lower_ind_.Reallocate(lower_ptr_(n));
+    lower_val_.Reallocate(lower_ptr_(n));
+    upper_ind_.Reallocate(upper_ptr_(n));
+    upper_val_.Reallocate(upper_ptr_(n));
+    for (int i = 0; i < n; i++)
+      {
+	for (int j = ptr(i); j < diag(i); j++)
+	  {
+	    lower_ind_(lower_ptr_(i) + j - ptr(i)) = ind(j);
+	    lower_val_(lower_ptr_(i) + j - ptr(i)) = val(j);
+	  }
+
+	for (int j = diag(i)+1; j < ptr(i+1); j++)
+	  {
+	    upper_ind_(upper_ptr_(i) + j - diag(i) - 1) = ind(j);
+	    upper_val_(upper_ptr_(i) + j - diag(i) - 1) = val(j);
+	  }
+      }
+
+    GetLevelSets(upper_ptr_, upper_ind_, false, upper_level_ptr_, upper_level_row_);
+  }
+
+
+  //! Efface la factorisation
+  template<class T>
+  void IluPreconditioner<T>::Clear()
+  {
+    lower_ptr_.Clear(); lower_ind_.Clear(); lower_val_.Clear();
+    upper_ptr_.Clear(); upper_ind_.Clear(); upper_val_.Clear();
+    invDiag_.Clear();
+    lower_level_ptr_.Clear(); lower_level_row_.Clear();
+    upper_level_ptr_.Clear(); upper_level_row_.Clear();
+  }
+
+
+  //! Applique le preconditionneur z = (LU)^{-1} r
+  template<class T>
+  void IluPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    Vector<T> unit_diag;
+    z = r;
+    SolveLowerTriangular(lower_ptr_, lower_ind_, lower_val_, unit_diag,
+			 lower_level_ptr_, lower_level_row_, z);
+
+    SolveUpperTriangular(upper_ptr_, upper_ind_, upper_val_, invDiag_,
+			 upper_level_ptr_, upper_level_row_, z);
+  }
+
+
+  /************************************
+   * IncompleteCholeskyPreconditioner *
+   ************************************/
+
+
+  //! Calcule la factorisation IC(0) de A (A = L D L^T, sans conjugaison)
+  /*!
+    Seuls la diagonale et la partie strictement inferieure de A sont utilisees,
+    la matrice A peut ensuite etre detruite.
+   */
+  template<class T>
+  void IncompleteCholeskyPreconditioner<T>::Factorize(const SparseMatrix<T>& A)
+  {
+    int n = A.GetM();
+
+    // partie strictement inferieure de A au format CSR et diagonale
+    Vector<T> diag(n);
+    lower_ptr_.Reallocate(n+1);
+    lower_ptr_(0) = 0;
+    for (int i = 0; i < n; i++)
+      {
+	int nb = 0;
+	diag(i) = T(0);
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if (A.Index(i, j) < i)
+	    nb++;
+	  else if (A.Index(i, j) == i)
+	    diag(i) = A.Value(i, j);
+
+	lower_ptr_(i+1) = lower_ptr_(i) + nb;
+      }
+
+    lower_ind_.Reallocate(lower_ptr_(n));
+    lower_val_.Reallocate(lower_ptr_(n));
+    for (int i = 0; i < n; i++)
+      {
+	int nb = lower_ptr_(i);
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if (A.Index(i, j) < i)
+	    {
+	      lower_ind_(nb) = A.Index(i, j);
+	      lower_val_(nb) = A.Value(i, j);
+	      nb++;
+	    }
+      }
+
+    GetLevelSets(lower_ptr_, lower_ind_, true, lower_level_ptr_, lower_level_row_);
+
+    Vector<int> position(size_t(GetNbThreads())*n);
+    position.Fill(-1);
+    invDiag_.Reallocate(n);
+    for (int l = 0; l < lower_level_ptr_.GetM()-1; l++)
+      {
+#pragma omp parallel for schedule(static)
+	for (int p = lower_level_ptr_(l); p < lower_level_ptr_(l+1); p++)
+	  {
+	    int i = lower_level_row_(p);
+	    int* pos = &position.GetData()[size_t(GetThreadNumber())*n];
+	    for (int j = lower_ptr_(i); j < lower_ptr_(i+1); j++)
+	      pos[lower_ind_(j)] = j;
+
+	    // L_ik = (a_ik - sum_{m < k} L_im D_m L_km) / D_k
+	    T d = diag(i);
+	    for (int j = lower_ptr_(i); j < lower_ptr_(i+1); j++)
+	      {
+		int k = lower_ind_(j);
+		T sum = lower_val_(j);
+		for (int m = lower_ptr_(k); m < lower_ptr_(k+1); m++)
+		  if (pos[lower_ind_(m)] >= 0)
+		    sum -= lower_val_(pos[lower_ind_(m)])*diag(lower_ind_(m))*lower_val_(m);
+
+		lower_val_(j) = sum*invDiag_(k);
+		d -= lower_val_(j)*sum;
+	      }
+
+	    if (d == T(0))
+	      {
+		cout << "pivot nul sur la ligne " << i << " de IC(0)" << endl;
+		abort();
+	      }
+
+	    // diag contient maintenant D
+	    diag(i) = d;
+	    invDiag_(i) = T(1) / d;
+	    for (int j = lower_ptr_(i); j < lower_ptr_(i+1); j++)
+	      pos[lower_ind_(j)] = -1;
+	  }
+      }
+
+    // L^T est stockee par lignes pour la remontee
+    upper_ptr_.Reallocate(n+1);
+    upper_ptr_.Zero();
+    for (int j = 0; j < lower_ptr_(n); j++)
+      upper_ptr_(lower_ind_(j)+1)++;
+
+    for (int i = 0; i < n; i++)
+      upper_ptr_(i+1) += upper_ptr_(i);
+
+    upper_ind_.Reallocate(upper_ptr_(n));
+    upper_val_.Reallocate(upper_ptr_(n));
+    Vector<int> nb(upper_ptr_);
+    for (int i = 0; i < n; i++)
+      for (int j = lower_ptr_(i); j < lower_ptr_(i+1); j++)
+	{
+	  int k = lower_ind_(j);
+	  upper_ind_(nb(k)) = i;
+	  upper_val_(nb(k)) = lower_val_(j);
+	  nb(k)++;
+	}
+
+    GetLevelSets(upper_ptr_, upper_ind_, false, upper_level_ptr_, upper_level_row_);
+  }
+
+
+  //! Efface la factorisation
+  template<class T>
+  void IncompleteCholeskyPreconditioner<T>::Clear()
+  {
+    lower_ptr_.Clear(); lower_ind_.Clear(); lower_val_.Clear();
+    upper_ptr_.Clear(); upper_ind_.Clear(); upper_val_.Clear();
+    invDiag_.Clear();
+    lower_level_ptr_.Clear(); lower_level_row_.Clear();
+    upper_level_ptr_.Clear(); upper_level_row_.Clear();
+  }
+
+
+  //! Applique le preconditionneur z = (L D L^T)^{-1} r
+  template<class T>
+  void IncompleteCholeskyPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    Vector<T> unit_diag;
+    z = r;
+    SolveLowerTriangular(lower_ptr_, lower_ind_, lower_val_, unit_diag,
+			 lower_level_ptr_, lower_level_row_, z);
+
+    for (int i = 0; i < z.GetM(); i++)
+      z(i) *= invDiag_(i);
+
+    SolveUpperTriangular(upper_ptr_, upper_ind_, upper_val_, unit_diag,
+			 upper_level_ptr_, upper_level_row_, z);
+  }
+
+}
+
+#define LINALG_FILE_PRECOND_ILU_CXX
+#endif
@@ -0,0 +1,71 @@
+#ifndef LINALG_FILE_PRECOND_ILU_HXX
+
+namespace linalg
+{
+
+  //! Preconditionneur ILU(0) : factorisation LU incomplete sur la structure de A
+  /*!
+    L (diagonale unite) et U sont stockees au format CSR. Les niveaux
+    (ensembles de lignes independantes) sont calcules une seule fois, la
+    factorisation et les resolutions triangulaires traitent en parallele
+    les lignes d'un meme niveau.
+   */
+  template<class T>
+  class IluPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! partie strictement inferieure de L
+    Vector<int> lower_ptr_, lower_ind_;
+    Vector<T> lower_val_;
+    //! partie strictement superieure de U
+    Vector<int> upper_ptr_, upper_ind_;
+    Vector<T> upper_val_;
+    //! inverse de la diagonale de U
+    Vector<T> invDiag_;
+    //! niveaux pour la descente et la remontee
+    Vector<int> lower_level_ptr_, lower_level_row_;
+    Vector<int> upper_level_ptr_, upper_level_row_;
+
+  public:
+    void Factorize(const SparseMatrix<T>& A);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+
+  //! Preconditionneur de Cholesky incomplet IC(0) : A = L D L^T sur la structure de A
+  /*!
+    La factorisation n'utilise pas de conjugaison, elle convient aux matrices
+    reelles symetriques et complexes symetriques (COCG). Seule la partie
+    inferieure de A est lue.
+   */
+  template<class T>
+  class IncompleteCholeskyPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! partie strictement inferieure de L
+    Vector<int> lower_ptr_, lower_ind_;
+    Vector<T> lower_val_;
+    //! L^T (stockee par lignes pour la remontee)
+    Vector<int> upper_ptr_, upper_ind_;
+    Vector<T> upper_val_;
+    //! inverse de D
+    Vector<T> invDiag_;
+    //! niveaux pour la descente et la remontee
+    Vector<int> lower_level_ptr_, lower_level_row_;
+    Vector<int> upper_level_ptr_, upper_level_row_;
+
+  public:
+    void Factorize(const SparseMatrix<T>& A);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+}
+
+#define LINALG_FILE_PRECOND_ILU_HXX
+#endif
@@ -0,0 +1,267 @@
+#ifndef LINALG_FILE_PRECOND_SPAI_CXX
+
+#include "PrecondSpai.hxx"
+
+namespace linalg
+{
+
+  //! Calcule une matrice P ayant la structure de A^level (avec la diagonale)
+  /*!
+    Seule la structure de P est significative, ses valeurs sont quelconques.
+   */
+  template<class T>
+  void GetPatternPower(const SparseMatrix<T>& A, int level, SparseMatrix<T>& P)
+  {
+    SparseMatrix<T> Q;
+    P = A;
+    P.UnfreezePattern();
+    for (int i = 0; i < min(P.GetM(), P.GetN()); i++)
+      P.AddInteraction(i, i, T(1));
+
+    for (int k = 1; k < level; k++)
+      {
+	P.MltM(A, Q);
+	P = Q;
+      }
+  }
+
+
+  /**********************
+   * FsaiPreconditioner *
+   **********************/
+
+
+  //! Constructeur par defaut
+  template<class T>
+  FsaiPreconditioner<T>::FsaiPreconditioner()
+  {
+    level_ = 1;
+  }
+
+
+  //! La structure de G sera celle de la partie inferieure de A^level
+  template<class T>
+  void FsaiPreconditioner<T>::SetPatternLevel(int level)
+  {
+    level_ = level;
+  }
+
+
+  //! Calcule le facteur G
+  /*!
+    Pour chaque ligne i de structure J (les colonnes j <= i), on resout
+    A(J, J) y = e_i puis G(i, J) = y / sqrt(y_i).
+   */
+  template<class T>
+  void FsaiPreconditioner<T>::Factorize(const SparseMatrix<T>& A)
+  {
+    int n = A.GetM();
+    SparseMatrix<T> pattern;
+    GetPatternPower(A, level_, pattern);
+
+    G_.Clear();
+    G_.Reallocate(n, n);
+    Vector<int> position(size_t(GetNbThreads())*n);
+    position.Fill(-1);
+    bool singular = false;
+
+#pragma omp parallel
+    {
+      int* pos = &position.GetData()[size_t(GetThreadNumber())*n];
+      Vector<T> Aloc, y;
+      Vector<int> pivot;
+#pragma omp for schedule(dynamic, 64) reduction(||:singular)
+      for (int i = 0; i < n; i++)
+	{
+	  // colonnes j <= i de la structure (i est la derniere)
+	  int size = 0;
+	  while ((size < pattern.GetRowSize(i)) && (pattern.Index(i, size) <= i))
+	    size++;
+
+	  for (int k = 0; k < size; k++)
+	    pos[pattern.Index(i, k)] = k;
+
+	  // extraction de A(J, J)
+	  Aloc.Reallocate(size*size);
+	  Aloc.Fill(T(0));
+	  for (int k = 0; k < size; k++)
+	    {
+	      int row = pattern.Index(i, k);
+	      for (int j = 0; j < A.GetRowSize(row); j++)
+		if (pos[A.Index(row, j)] >= 0)
+		  Aloc(size*k + pos[A.Index(row, j)]) = A.Value(row, j);
+	    }
+
+	  y.Reallocate(size);
+	  y.Fill(T(0));
+	  y(size-1) = T(1);
+	  GetLU(size, Aloc, pivot);
+	  SolveLU(size, Aloc, pivot, y);
+
+	  T coef = sqrt(y(size-1));
+	  if (!(abs(coef) > 0))
+	    singular = true;
+	  else
+	    coef = T(1) / coef;
+
+	  SparseVector<T>& row = G_.GetLine(i);
+	  row.Reallocate(size);
+	  for (int k = 0; k < size; k++)
+	    {
+	      row.Index(k) = pattern.Index(i, k);
+	      row.Value(k) = coef*y(k);
+	      pos[pattern.Index(i, k)] = -1;
+	    }
+	}
+    }
+
+    if (singular)
+      {
+	cout << "FSAI : la matrice n'est pas definie positive" << endl;
+	abort();
+      }
+
+    G_.Transpose(Gt_);
+    tmp_.Reallocate(n);
+  }
+
+
+  //! Efface le facteur G
+  template<class T>
+  void FsaiPreconditioner<T>::Clear()
+  {
+    G_.Clear();
+    Gt_.Clear();
+    tmp_.Clear();
+  }
+
+
+  //! Applique le preconditionneur z = G^T G r
+  template<class T>
+  void FsaiPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    z.Reallocate(r.GetM());
+    G_.Mlt(r, tmp_);
+    Gt_.Mlt(tmp_, z);
+  }
+
+
+  /**********************
+   * SpaiPreconditioner *
+   **********************/
+
+
+  //! Constructeur par defaut
+  template<class T>
+  SpaiPreconditioner<T>::SpaiPreconditioner()
+  {
+    level_ = 1;
+  }
+
+
+  //! La structure de M sera celle de A^level
+  template<class T>
+  void SpaiPreconditioner<T>::SetPatternLevel(int level)
+  {
+    level_ = level;
+  }
+
+
+  //! Calcule l'inverse approchee M
+  /*!
+    La ligne i de M, de structure J, est la solution du probleme aux
+    moindres carres min |sum_{j in J} m_ij A(j, I) - e_i(I)| ou I est la
+    reunion des colonnes des lignes J de A.
+   */
+  template<class T>
+  void SpaiPreconditioner<T>::Factorize(const SparseMatrix<T>& A)
+  {
+    int n = A.GetM();
+    SparseMatrix<T> pattern;
+    GetPatternPower(A, level_, pattern);
+
+    M_.Clear();
+    M_.Reallocate(n, n);
+    Vector<int> position(size_t(GetNbThreads())*n);
+    position.Fill(-1);
+
+#pragma omp parallel
+    {
+      int* pos = &position.GetData()[size_t(GetThreadNumber())*n];
+      Vector<int> col;
+      Vector<T> B, rhs;
+#pragma omp for schedule(dynamic, 64)
+      for (int i = 0; i < n; i++)
+	{
+	  // colonnes I touchees par les lignes J de A
+	  int size = pattern.GetRowSize(i), nb = 0;
+	  for (int k = 0; k < size; k++)
+	    nb += A.GetRowSize(pattern.Index(i, k));
+
+	  if (col.GetM() < nb)
+	    col.Reallocate(nb);
+
+	  nb = 0;
+	  for (int k = 0; k < size; k++)
+	    {
+	      int row = pattern.Index(i, k);
+	      for (int j = 0; j < A.GetRowSize(row); j++)
+		if (pos[A.Index(row, j)] < 0)
+		  {
+		    pos[A.Index(row, j)] = nb;
+		    col(nb++) = A.Index(row, j);
+		  }
+	    }
+
+	  // B(p, k) = A(J_k, I_p)
+	  B.Reallocate(nb*size);
+	  B.Fill(T(0));
+	  for (int k = 0; k < size; k++)
+	    {
+	      int row = pattern.Index(i, k);
+	      for (int j = 0; j < A.GetRowSize(row); j++)
+		B(size*pos[A.Index(row, j)] + k) = A.Value(row, j);
+	    }
+
+	  rhs.Reallocate(nb);
+	  rhs.Fill(T(0));
+	  if (pos[i] >= 0)
+	    rhs(pos[i]) = T(1);
+
+	  SolveLeastSquares(nb, size, B, rhs);
+
+	  SparseVector<T>& line = M_.GetLine(i);
+	  line.Reallocate(size);
+	  for (int k = 0; k < size; k++)
+	    {
+	      line.Index(k) = pattern.Index(i, k);
+	      line.Value(k) = rhs(k);
+	    }
+
+	  for (int p = 0; p < nb; p++)
+	    pos[col(p)] = -1;
+	}
+    }
+  }
+
+
+  //! Efface l'inverse approchee
+  template<class T>
+  void SpaiPreconditioner<T>::Clear()
+  {
+    M_.Clear();
+  }
+
+
+  //! Applique le preconditionneur z = M r
+  template<class T>
+  void SpaiPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    z.Reallocate(r.GetM());
+    M_.Mlt(r, z);
+  }
+
+}
+
+#define LINALG_FILE_PRECOND_SPAI_CXX
+#endif
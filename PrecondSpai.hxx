@@ -0,0 +1,72 @@
+#ifndef LINALG_FILE_PRECOND_SPAI_HXX
+
+namespace linalg
+{
+
+  //! Inverse approchee factorisee (FSAI) : A^{-1} ~ G^T G
+  /*!
+    G est triangulaire inferieure avec la structure de la partie inferieure
+    de A (ou de A^level), elle est calculee ligne par ligne (en parallele) de
+    sorte que G A G^T soit proche de l'identite. Aucune conjugaison n'est
+    faite, A doit etre symetrique (reelle definie positive ou complexe
+    symetrique pour COCG). L'application est composee de deux produits
+    matrice-vecteur.
+   */
+  template<class T>
+  class FsaiPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! la structure de G est celle de A^level_
+    int level_;
+    //! facteur G et sa transposee
+    SparseMatrix<T> G_, Gt_;
+    //! vecteur de travail
+    Vector<T> tmp_;
+
+  public:
+    FsaiPreconditioner();
+
+    void SetPatternLevel(int level);
+    void Factorize(const SparseMatrix<T>& A);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+
+  //! Inverse approchee creuse (SPAI) : M ~ A^{-1} pour une matrice quelconque
+  /*!
+    Chaque ligne m_i de M (avec la structure de la ligne i de A ou de
+    A^level) minimise |m_i A - e_i| au sens des moindres carres. Les lignes
+    sont calculees en parallele et l'application est un produit
+    matrice-vecteur.
+   */
+  template<class T>
+  class SpaiPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! la structure de M est celle de A^level_
+    int level_;
+    //! inverse approchee
+    SparseMatrix<T> M_;
+
+  public:
+    SpaiPreconditioner();
+
+    void SetPatternLevel(int level);
+    void Factorize(const SparseMatrix<T>& A);
+    void Clear();
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+
+  };
+
+
+  template<class T>
+  void GetPatternPower(const SparseMatrix<T>& A, int level, SparseMatrix<T>& P);
+
+}
+
+#define LINALG_FILE_PRECOND_SPAI_HXX
+#endif
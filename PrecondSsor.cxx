@@ -0,0 +1,199 @@
+#ifndef LINALG_FILE_PRECOND_SSOR_CXX
+
+#include "PrecondSsor.hxx"
+
+namespace linalg
+{
+
+  //! Calcule l'inverse de la diagonale de A
+  template<class T>
+  void GetInverseDiagonal(const SparseMatrix<T>& A, Vector<T>& invDiag)
+  {
+    invDiag.Reallocate(A.GetM());
+    for (int i = 0; i < A.GetM(); i++)
+      {
+	int k = A.FindIndex(i, i);
+	if ((k < 0) || (A.Value(i, k) == T(0)))
+	  {
+	    cout << "le coefficient diagonal " << i << " est nul" << endl;
+	    abort();
+	  }
+	
+	invDiag(i) = T(1) / A.Value(i, k);
+      }
+  }
+  
+  
+  //! Constructeur par defaut
+  template<class T>
+  MulticolorSsorPreconditioner<T>::MulticolorSsorPreconditioner()
+  {
+    A_ = NULL;
+    omega_ = 1.0;
+    nb_iter_ = 1;
+  }
+  
+  
+  //! Change le parametre de relaxation et le nombre d'iterations de SSOR
+  template<class T>
+  void MulticolorSsorPreconditioner<T>::SetParameters(double omega, int nb_iter)
+  {
+    omega_ = omega;
+    nb_iter_ = nb_iter;
+  }
+  
+  
+  //! Initialise le preconditionneur avec la matrice A
+  /*!
+    La matrice A est conservee par reference, elle doit exister tant que
+    le preconditionneur est utilise. Le coloriage est calcule ici
+    (et stocke dans A) s'il ne l'a pas deja ete.
+   */
+  template<class T>
+  void MulticolorSsorPreconditioner<T>::Init(const SparseMatrix<T>& A)
+  {
+    A_ = &A;
+    GetInverseDiagonal(A, invDiag_);
+    if (A.GetNbColors() == 0)
+      A.ComputeColoring();
+  }
+  
+  
+  //! Applique le preconditionneur z = M r
+  template<class T>
+  void MulticolorSsorPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    z.Reallocate(r.GetM());
+    z.Fill(T(0));
+    for (int k = 0; k < nb_iter_; k++)
+      A_->ApplyMulticolorSsor(r, invDiag_, z, omega_);
+  }
+  
+  
+  //! Constructeur par defaut
+  template<class T>
+  SsorPreconditioner<T>::SsorPreconditioner()
+  {
+    omega_ = 1.0;
+    nb_iter_ = 1;
+  }
+  
+  
+  //! Change le parametre de relaxation et le nombre d'iterations de SSOR
+  template<class T>
+  void SsorPreconditioner<T>::SetParameters(double omega, int nb_iter)
+  {
+    omega_ = omega;
+    nb_iter_ = nb_iter;
+  }
+  
+  
+  //! Initialise le preconditionneur avec la matrice A (qui peut ensuite etre detruite)
+  template<class T>
+  void SsorPreconditioner<T>::Init(const SparseMatrix<T>& A)
+  {
+    int n = A.GetM();
+    GetInverseDiagonal(A, invDiag_);
+    
+    lower_ptr_.Reallocate(n+1);
+    upper_ptr_.Reallocate(n+1);
+    lower_ptr_(0) = 0;
+    upper_ptr_(0) = 0;
+    for (int i = 0; i < n; i++)
+      {
+	int nb_lower = 0, nb_upper = 0;
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if (A.Index(i, j) < i)
+	    nb_lower++;
+	  else if (A.Index(i, j) > i)
+	    nb_upper++;
+	
+	lower_ptr_(i+1) = lower_ptr_(i) + nb_lower;
+	upper_ptr_(i+1) = upper_ptr_(i) + nb_upper;
+      }
+    
+    lower_ind_.Reallocate(lower_ptr_(n));
+    lower_val_.Reallocate(lower_ptr_(n));
+    upper_ind_.Reallocate(upper_ptr_(n));
+    upper_val_.Reallocate(upper_ptr_(n));
+    for (int i = 0; i < n; i++)
+      {
+	int nb_lower = lower_ptr_(i), nb_upper = upper_ptr_(i);
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if (A.Index(i, j) < i)
+	    {
+	      lower_ind_(nb_lower) = A.Index(i, j);
+	      lower_val_(nb_lower) = A.Value(i, j);
+	      nb_lower++;
+	    }
+	  else if (A.Index(i, j) > i)
+	    {
+	      upper_ind_(nb_upper) = A.Index(i, j);
+	      upper_val_(nb_upper) = A.Value(i, j);
+	      nb_upper++;
+	    }
+      }
+  }
+  
+  
+  //! Efface le preconditionneur
+  template<class T>
+  void SsorPreconditioner<T>::Clear()
+  {
+    lower_ptr_.Clear(); lower_ind_.Clear(); lower_val_.Clear();
+    upper_ptr_.Clear(); upper_ind_.Clear(); upper_val_.Clear();
+    invDiag_.Clear();
+  }
+  
+  
+  //! Applique le preconditionneur z = M r
+  /*!
+    On effectue nb_iter iterations de SSOR pour A z = r en partant de z = 0.
+    La mise a jour de la ligne i est
+    z_i = (1-omega) z_i + omega D_i^{-1} (r_i - L_i z - U_i z),
+    lors de la premiere descente z est nul au-dessus de la diagonale et
+    la partie superieure n'est pas parcourue.
+   */
+  template<class T>
+  void SsorPreconditioner<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    int n = r.GetM();
+    z.Reallocate(n);
+    z.Fill(T(0));
+    
+    T one_minus_omega = T(1.0 - omega_), omega = T(omega_), val;
+    for (int k = 0; k < nb_iter_; k++)
+      {
+	// descente
+	for (int i = 0; i < n; i++)
+	  {
+	    val = r(i);
+	    for (int j = lower_ptr_(i); j < lower_ptr_(i+1); j++)
+	      val -= lower_val_(j)*z(lower_ind_(j));
+	    
+	    if (k > 0)
+	      for (int j = upper_ptr_(i); j < upper_ptr_(i+1); j++)
+		val -= upper_val_(j)*z(upper_ind_(j));
+	    
+	    z(i) = one_minus_omega*z(i) + omega*invDiag_(i)*val;
+	  }
+	
+	// remontee
+	for (int i = n-1; i >= 0; i--)
+	  {
+	    val = r(i);
+	    for (int j = lower_ptr_(i); j < lower_ptr_(i+1); j++)
+	      val -= lower_val_(j)*z(lower_ind_(j));
+	    
+	    for (int j = upper_ptr_(i); j < upper_ptr_(i+1); j++)
+	      val -= upper_val_(j)*z(upper_ind_(j));
+	    
+	    z(i) = one_minus_omega*z(i) + omega*invDiag_(i)*val;
+	  }
+      }
+  }
+  
+}
+
+#define LINALG_FILE_PRECOND_SSOR_CXX
+#endif
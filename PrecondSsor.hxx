@@ -0,0 +1,72 @@
+#ifndef LINALG_FILE_PRECOND_SSOR_HXX
+
+namespace linalg
+{
+
+  //! Preconditionneur SSOR multicouleur (les lignes d'une couleur sont traitees en parallele)
+  template<class T>
+  class MulticolorSsorPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! matrice du systeme lineaire
+    const SparseMatrix<T>* A_;
+    //! inverse de la diagonale de A
+    Vector<T> invDiag_;
+    //! parametre de relaxation
+    double omega_;
+    //! nombre d'iterations de SSOR
+    int nb_iter_;
+    
+  public:
+    MulticolorSsorPreconditioner();
+    
+    void SetParameters(double omega, int nb_iter = 1);
+    void Init(const SparseMatrix<T>& A);
+    
+    void Solve(const Vector<T>& r, Vector<T>& z);
+    
+  };
+  
+  //! Preconditionneur SSOR avec stockage separe des parties triangulaires
+  /*!
+    Les parties strictement inferieure et superieure de A sont stockees
+    de facon contigue (format CSR) et l'inverse de la diagonale est calcule
+    une fois pour toutes. Chaque iteration est une descente suivie d'une
+    remontee, ce qui donne un preconditionneur symetrique utilisable avec
+    le gradient conjugue.
+   */
+  template<class T>
+  class SsorPreconditioner : public VirtualPreconditioner<T>
+  {
+  protected:
+    //! partie strictement inferieure de A
+    Vector<int> lower_ptr_, lower_ind_;
+    Vector<T> lower_val_;
+    //! partie strictement superieure de A
+    Vector<int> upper_ptr_, upper_ind_;
+    Vector<T> upper_val_;
+    //! inverse de la diagonale de A
+    Vector<T> invDiag_;
+    //! parametre de relaxation
+    double omega_;
+    //! nombre d'iterations de SSOR
+    int nb_iter_;
+    
+  public:
+    SsorPreconditioner();
+    
+    void SetParameters(double omega, int nb_iter = 1);
+    void Init(const SparseMatrix<T>& A);
+    void Clear();
+    
+    void Solve(const Vector<T>& r, Vector<T>& z);
+    
+  };
+  
+  template<class T>
+  void GetInverseDiagonal(const SparseMatrix<T>& A, Vector<T>& invDiag);
+  
+}
+
+#define LINALG_FILE_PRECOND_SSOR_HXX
+#endif
@@ -0,0 +1,445 @@
+#ifndef LINALG_FILE_RECYCLING_CG_CXX
+
+#include "RecyclingCg.hxx"
+
+namespace linalg
+{
+
+  //! Constructeur par defaut (8 vecteurs de deflation, 20 directions, 2 solutions)
+  template<class T>
+  RecyclingCgSolver<T>::RecyclingCgSolver()
+  {
+    nb_defl_max_ = 8;
+    nb_store_ = 20;
+    nb_sol_max_ = 2;
+    nb_defl_ = 0;
+    nb_dir_ = 0;
+    nb_sol_ = 0;
+    next_sol_ = 0;
+    nb_iter_ = 0;
+  }
+
+
+  //! Modifie les tailles des espaces recycles (l'espace courant est efface)
+  /*!
+    \param[in] nb_defl nombre maximal de vecteurs de deflation
+    \param[in] nb_store nombre de directions de descente utilisees pour l'extraction
+    \param[in] nb_sol nombre de solutions precedentes utilisees pour la donnee initiale
+   */
+  template<class T>
+  void RecyclingCgSolver<T>::SetParameters(int nb_defl, int nb_store, int nb_sol)
+  {
+    Clear();
+    nb_defl_max_ = nb_defl;
+    nb_store_ = nb_store;
+    nb_sol_max_ = nb_sol;
+  }
+
+
+  //! Efface l'espace de deflation et les solutions conservees
+  template<class T>
+  void RecyclingCgSolver<T>::Clear()
+  {
+    nb_defl_ = 0;
+    nb_dir_ = 0;
+    nb_sol_ = 0;
+    next_sol_ = 0;
+    W_.Clear(); AW_.Clear(); invE_.Clear();
+    P_.Clear(); AP_.Clear();
+    X_.Clear(); AX_.Clear();
+  }
+
+
+  //! Retourne le nombre d'iterations effectuees lors du dernier appel a Solve
+  template<class T>
+  int RecyclingCgSolver<T>::GetNbIterations() const
+  {
+    return nb_iter_;
+  }
+
+
+  //! Retourne le nombre de vecteurs de deflation courants
+  template<class T>
+  int RecyclingCgSolver<T>::GetNbDeflationVectors() const
+  {
+    return nb_defl_;
+  }
+
+
+  //! Donnee initiale par projection de Galerkin sur [W, X_1, ..., X_s]
+  /*!
+    En sortie, r_ contient le residu b - A x. La matrice projetee est
+    inversee par diagonalisation en ignorant les valeurs propres
+    negligeables, les solutions precedentes pouvant etre presque liees.
+   */
+  template<class T>
+  void RecyclingCgSolver<T>::ComputeInitialGuess(const VirtualMatrix<T>& A, Vector<T>& x,
+						 const Vector<T>& b)
+  {
+    int n = b.GetM(), k = nb_defl_, m = nb_defl_ + nb_sol_;
+    r_ = b;
+    A.MltAdd(T(-1), x, r_);
+    if (m == 0)
+      return;
+
+    // M = U^T A U et c = U^T r en un seul parcours
+    Vector<T> M(m*m), c(m);
+    M.Fill(T(0));
+    c.Fill(T(0));
+#pragma omp parallel
+    {
+      Vector<T> M_loc(m*m), c_loc(m);
+      M_loc.Fill(T(0));
+      c_loc.Fill(T(0));
+#pragma omp for schedule(static)
+      for (int i = 0; i < n; i++)
+	for (int a = 0; a < m; a++)
+	  {
+	    T ua = (a < k) ? W_(a)(i) : X_(a-k)(i);
+	    c_loc(a) += ua*r_(i);
+	    for (int j = 0; j < m; j++)
+	      M_loc(m*a + j) += ua*((j < k) ? AW_(j)(i) : AX_(j-k)(i));
+	  }
+
+#pragma omp critical
+      {
+	Add(T(1), M_loc, M);
+	Add(T(1), c_loc, c);
+      }
+    }
+
+    for (int a = 0; a < m; a++)
+      for (int j = 0; j < a; j++)
+	{
+	  M(m*a + j) = T(0.5)*(M(m*a + j) + M(m*j + a));
+	  M(m*j + a) = M(m*a + j);
+	}
+
+    // y = M^+ c
+    Vector<T> lambda, V, y(m), tmp(m);
+    GetSymmetricEigenvalues(m, M, lambda, V);
+    double lambda_max = 0;
+    for (int a = 0; a < m; a++)
+      lambda_max = max(lambda_max, double(abs(lambda(a))));
+
+    for (int a = 0; a < m; a++)
+      {
+	tmp(a) = T(0);
+	if (abs(lambda(a)) > 1e-12*lambda_max)
+	  {
+	    for (int j = 0; j < m; j++)
+	      tmp(a) += V(m*j + a)*c(j);
+
+	    tmp(a) /= lambda(a);
+	  }
+      }
+
+    for (int j = 0; j < m; j++)
+      {
+	y(j) = T(0);
+	for (int a = 0; a < m; a++)
+	  y(j) += V(m*j + a)*tmp(a);
+      }
+
+    // x = x + U y, r = r - A U y
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+      for (int a = 0; a < m; a++)
+	{
+	  x(i) += y(a)*((a < k) ? W_(a)(i) : X_(a-k)(i));
+	  r_(i) -= y(a)*((a < k) ? AW_(a)(i) : AX_(a-k)(i));
+	}
+  }
+
+
+  //! Calcule p = z + beta p - W (W^T A W)^{-1} (A W)^T z
+  template<class T>
+  void RecyclingCgSolver<T>::ApplyDeflation(const Vector<T>& z, Vector<T>& p, T beta)
+  {
+    int n = z.GetM(), k = nb_defl_;
+    if (k == 0)
+      {
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	  p(i) = z(i) + beta*p(i);
+
+	return;
+      }
+
+    // produits scalaires (A w_a, z) en un seul parcours
+    Vector<T> az(k);
+    az.Fill(T(0));
+#pragma omp parallel
+    {
+      Vector<T> az_loc(k);
+      az_loc.Fill(T(0));
+#pragma omp for schedule(static)
+      for (int i = 0; i < n; i++)
+	for (int a = 0; a < k; a++)
+	  az_loc(a) += AW_(a)(i)*z(i);
+
+#pragma omp critical
+      Add(T(1), az_loc, az);
+    }
+
+    for (int a = 0; a < k; a++)
+      {
+	mu_(a) = T(0);
+	for (int j = 0; j < k; j++)
+	  mu_(a) += invE_(k*a + j)*az(j);
+      }
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+      {
+	T val = z(i) + beta*p(i);
+	for (int a = 0; a < k; a++)
+	  val -= mu_(a)*W_(a)(i);
+
+	p(i) = val;
+      }
+  }
+
+
+  //! Extrait le nouvel espace de deflation de [W, P] (vecteurs de Ritz)
+  /*!
+    On resout le probleme aux valeurs propres generalise Z^T A Z y = theta Z^T Z y
+    avec Z = [W, P] et on garde les vecteurs Z y associes aux plus petites
+    valeurs |theta|. Z^T Z est d'abord diagonalisee pour eliminer les
+    directions liees. Les vecteurs de Ritz approchent les modes propres de A
+    (et non de M^{-1} A), ce sont ceux que la deflation elimine.
+   */
+  template<class T>
+  void RecyclingCgSolver<T>::Harvest()
+  {
+    int n = r_.GetM(), k = nb_defl_, m = nb_defl_ + nb_dir_;
+    if ((nb_defl_max_ == 0) || (m == 0))
+      return;
+
+    // F = Z^T A Z et G = Z^T Z en un seul parcours
+    Vector<T> F(m*m), G(m*m);
+    F.Fill(T(0));
+    G.Fill(T(0));
+#pragma omp parallel
+    {
+      Vector<T> F_loc(m*m), G_loc(m*m);
+      F_loc.Fill(T(0));
+      G_loc.Fill(T(0));
+#pragma omp for schedule(static)
+      for (int i = 0; i < n; i++)
+	for (int a = 0; a < m; a++)
+	  {
+	    T za = (a < k) ? W_(a)(i) : P_(a-k)(i);
+	    for (int j = a; j < m; j++)
+	      {
+		F_loc(m*a + j) += za*((j < k) ? AW_(j)(i) : AP_(j-k)(i));
+		G_loc(m*a + j) += za*((j < k) ? W_(j)(i) : P_(j-k)(i));
+	      }
+	  }
+
+#pragma omp critical
+      {
+	Add(T(1), F_loc, F);
+	Add(T(1), G_loc, G);
+      }
+    }
+
+    for (int a = 0; a < m; a++)
+      for (int j = 0; j < a; j++)
+	{
+	  F(m*a + j) = F(m*j + a);
+	  G(m*a + j) = G(m*j + a);
+	}
+
+    // Q = U diag(g)^{-1/2} sur les valeurs propres non negligeables de G
+    Vector<T> g, U;
+    GetSymmetricEigenvalues(m, G, g, U);
+    double g_max = 0;
+    for (int a = 0; a < m; a++)
+      g_max = max(g_max, double(abs(g(a))));
+
+    Vector<int> keep;
+    for (int a = 0; a < m; a++)
+      if (abs(g(a)) > 1e-10*g_max)
+	keep.PushBack(a);
+
+    int m2 = keep.GetM();
+    Vector<T> Q(m*m2);
+    for (int j = 0; j < m; j++)
+      for (int a = 0; a < m2; a++)
+	Q(m2*j + a) = U(m*j + keep(a)) / sqrt(g(keep(a)));
+
+    // Ft = Q^T F Q, puis Ft = Y diag(theta) Y^T
+    Vector<T> FQ(m*m2), Ft(m2*m2), theta, Y;
+    FQ.Fill(T(0));
+    Ft.Fill(T(0));
+    for (int j = 0; j < m; j++)
+      for (int l = 0; l < m; l++)
+	for (int a = 0; a < m2; a++)
+	  FQ(m2*j + a) += F(m*j + l)*Q(m2*l + a);
+
+    for (int a = 0; a < m2; a++)
+      for (int b = 0; b < m2; b++)
+	for (int j = 0; j < m; j++)
+	  Ft(m2*a + b) += Q(m2*j + a)*FQ(m2*j + b);
+
+    GetSymmetricEigenvalues(m2, Ft, theta, Y);
+
+    // selection des plus petites valeurs |theta|
+    Vector<int> order(m2);
+    for (int a = 0; a < m2; a++)
+      order(a) = a;
+
+    int k_new = min(nb_defl_max_, m2);
+    for (int a = 0; a < k_new; a++)
+      for (int b = a+1; b < m2; b++)
+	if (abs(theta(order(b))) < abs(theta(order(a))))
+	  swap(order(a), order(b));
+
+    // C = Q Y(:, selection)
+    Vector<T> C(m*k_new);
+    C.Fill(T(0));
+    for (int j = 0; j < m; j++)
+      for (int a = 0; a < k_new; a++)
+	for (int l = 0; l < m2; l++)
+	  C(k_new*j + a) += Q(m2*j + l)*Y(m2*l + order(a));
+
+    // W = Z C, calcule dans AW_ qui sera de toute facon recalcule
+    W_.Reallocate(nb_defl_max_);
+    AW_.Reallocate(nb_defl_max_);
+    for (int a = 0; a < k_new; a++)
+      AW_(a).Reallocate(n);
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+      for (int a = 0; a < k_new; a++)
+	{
+	  T val(0);
+	  for (int j = 0; j < m; j++)
+	    val += C(k_new*j + a)*((j < k) ? W_(j)(i) : P_(j-k)(i));
+
+	  AW_(a)(i) = val;
+	}
+
+    for (int a = 0; a < k_new; a++)
+      W_(a) = AW_(a);
+
+    nb_defl_ = k_new;
+  }
+
+
+  //! Resout le systeme lineaire A x = b par gradient conjugue deflate
+  /*!
+    \param[in] A matrice associee au systeme lineaire a resoudre
+    \param[inout] x en entree "initial guess", en sortie la solution
+    \param[in] b second membre
+    \param[in] prec preconditioneur a utiliser
+    \param[in] epsilon critere d'arret
+    \param[in] nb_iter_max nombre maximal d'iterations
+    La matrice peut changer d'un appel a l'autre (A W est recalcule au debut
+    de chaque resolution), la taille du systeme doit rester la meme.
+   */
+  template<class T>
+  void RecyclingCgSolver<T>::Solve(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+				   VirtualPreconditioner<T>& prec, double epsilon, int nb_iter_max)
+  {
+    int n = b.GetM();
+    if (r_.GetM() != n)
+      Clear();
+
+    r_.Reallocate(n); z_.Reallocate(n); p_.Reallocate(n); q_.Reallocate(n);
+    mu_.Reallocate(nb_defl_max_);
+
+    // A W et A X avec la matrice courante
+    int k = nb_defl_;
+    for (int a = 0; a < k; a++)
+      A.Mlt(W_(a), AW_(a));
+
+    for (int a = 0; a < nb_sol_; a++)
+      A.Mlt(X_(a), AX_(a));
+
+    if (k > 0)
+      {
+	invE_.Reallocate(k*k);
+	invE_.Fill(T(0));
+#pragma omp parallel
+	{
+	  Vector<T> E_loc(k*k);
+	  E_loc.Fill(T(0));
+#pragma omp for schedule(static)
+	  for (int i = 0; i < n; i++)
+	    for (int a = 0; a < k; a++)
+	      for (int j = 0; j < k; j++)
+		E_loc(k*a + j) += W_(a)(i)*AW_(j)(i);
+
+#pragma omp critical
+	  Add(T(1), E_loc, invE_);
+	}
+
+	GetInverse(k, invE_);
+      }
+
+    ComputeInitialGuess(A, x, b);
+
+    double norm_b = abs(Norm2(b));
+    if (norm_b == 0)
+      norm_b = 1;
+
+    P_.Reallocate(nb_store_);
+    AP_.Reallocate(nb_store_);
+    nb_dir_ = 0;
+    nb_iter_ = 0;
+    if (abs(Norm2(r_))/norm_b > epsilon)
+      {
+	// p_ peut contenir n'importe quoi (premier appel), beta*p doit etre nul
+	p_.Zero();
+	prec.Solve(r_, z_);
+	ApplyDeflation(z_, p_, T(0));
+	T rho = DotProd(r_, z_);
+	while (nb_iter_ < nb_iter_max)
+	  {
+	    A.Mlt(p_, q_);
+	    if (nb_dir_ < nb_store_)
+	      {
+		P_(nb_dir_) = p_;
+		AP_(nb_dir_) = q_;
+		nb_dir_++;
+	      }
+
+	    T alpha = rho / DotProd(p_, q_);
+	    Add(alpha, p_, x);
+	    Add(-alpha, q_, r_);
+
+	    nb_iter_++;
+	    double res = abs(Norm2(r_))/norm_b;
+	    if (nb_iter_%10 == 0)
+	      cout << "Residu at iteration " << nb_iter_ << " = " << res << endl;
+
+	    if (res <= epsilon)
+	      break;
+
+	    prec.Solve(r_, z_);
+	    T rho_new = DotProd(r_, z_);
+	    ApplyDeflation(z_, p_, rho_new/rho);
+	    rho = rho_new;
+	  }
+      }
+
+    Harvest();
+
+    // la solution est conservee pour les prochaines donnees initiales
+    if (nb_sol_max_ > 0)
+      {
+	X_.Reallocate(nb_sol_max_);
+	AX_.Reallocate(nb_sol_max_);
+	X_(next_sol_) = x;
+	AX_(next_sol_).Reallocate(n);
+	next_sol_ = (next_sol_+1)%nb_sol_max_;
+	nb_sol_ = min(nb_sol_+1, nb_sol_max_);
+      }
+  }
+
+}
+
+#define LINALG_FILE_RECYCLING_CG_CXX
+#endif
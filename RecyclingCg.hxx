@@ -0,0 +1,65 @@
+#ifndef LINALG_FILE_RECYCLING_CG_HXX
+
+namespace linalg
+{
+
+  //! Gradient conjugue deflate avec recyclage d'un sous-espace entre deux resolutions
+  /*!
+    Destine aux suites de systemes voisins (pas de temps, balayage en
+    parametre). A la fin de chaque resolution, des vecteurs de Ritz associes
+    aux plus petites valeurs propres sont extraits de l'espace de deflation
+    courant et des premieres directions de descente, et servent a deflater
+    la resolution suivante. Les dernieres solutions sont aussi conservees
+    pour construire la donnee initiale (projection de Galerkin).
+    Comme ConjugateGradient, les produits scalaires ne sont pas conjugues
+    (matrices reelles symetriques ou complexes symetriques).
+   */
+  template<class T>
+  class RecyclingCgSolver
+  {
+  protected:
+    //! nombre maximal de vecteurs de deflation
+    int nb_defl_max_;
+    //! nombre de directions de descente conservees pour l'extraction de Ritz
+    int nb_store_;
+    //! nombre maximal de solutions precedentes conservees
+    int nb_sol_max_;
+    //! espace de deflation W et produit A W
+    int nb_defl_;
+    Vector<Vector<T> > W_, AW_;
+    //! inverse de W^T A W (stockee par lignes)
+    Vector<T> invE_;
+    //! directions de descente p_j et A p_j de la derniere resolution
+    int nb_dir_;
+    Vector<Vector<T> > P_, AP_;
+    //! solutions precedentes et leurs produits par A (tampon circulaire)
+    int nb_sol_, next_sol_;
+    Vector<Vector<T> > X_, AX_;
+    //! vecteurs de travail
+    Vector<T> r_, z_, p_, q_, mu_;
+    //! nombre d'iterations effectuees lors du dernier appel a Solve
+    int nb_iter_;
+
+    void ComputeInitialGuess(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b);
+    void ApplyDeflation(const Vector<T>& z, Vector<T>& p, T beta);
+    void Harvest();
+
+  public:
+    RecyclingCgSolver();
+
+    void SetParameters(int nb_defl, int nb_store = 20, int nb_sol = 2);
+    void Clear();
+
+    int GetNbIterations() const;
+    int GetNbDeflationVectors() const;
+
+    void Solve(const VirtualMatrix<T>& A, Vector<T>& x, const Vector<T>& b,
+	       VirtualPreconditioner<T>& prec, double epsilon = 1e-6,
+	       int nb_iter_max = 1000);
+
+  };
+
+}
+
+#define LINALG_FILE_RECYCLING_CG_HXX
+#endif
@@ -5,6 +5,22 @@
 namespace linalg
 {
 
+  //! Mumps is called in single precision
+  template<>
+  void MatrixMumps<float>::CallMumps()
+  {
+    smumps_c(&struct_mumps);
+  }
+
+
+  //! Mumps is called in complex single precision
+  template<>
+  void MatrixMumps<complex<float> >::CallMumps()
+  {
+    cmumps_c(&struct_mumps);
+  }
+
+
   //! Mumps is called in double precision
   template<>
   void MatrixMumps<double>::CallMumps()
@@ -44,13 +60,40 @@ namespace linalg
     coef_overestimate = 1.3;
     coef_increase_memory = 1.5;
     coef_max_overestimate = 50.0;
+    memory_budget = 0;
+    nb_retries = 0;
+    batch_size = 16;
+    block_low_rank = false;
+    blr_tolerance = 1e-8;
+    blr_variant = 0;
   }
 
 
   //! Function used to force factorisation when estimated space was too small
+  /*!
+    With a memory budget, the workspace cannot grow : the factorization is
+    retried once out of core if it was in core. Otherwise, ICNTL(14) is
+    increased until the factorization succeeds.
+  */
   template<class T>
   void MatrixMumps<T>::IterateFacto()
   {
+    if (memory_budget > 0)
+      {
+	if (((struct_mumps.info[0] == -9) || (struct_mumps.info[0] == -8)
+	     || (struct_mumps.info[0] == -17) || (struct_mumps.info[0] == -20))
+	    && (struct_mumps.icntl[21] == 0))
+	  {
+	    struct_mumps.icntl[21] = 1;
+	    struct_mumps.job = 2;
+	    CallMumps();
+	    nb_retries++;
+	  }
+	
+	info_facto = struct_mumps.info[0];
+	return;
+      }
+    
     // if error -9 occurs, retrying with larger size
     int init_percentage = struct_mumps.icntl[13];
     int new_percentage = init_percentage;
@@ -62,6 +105,7 @@ namespace linalg
         struct_mumps.icntl[13] = new_percentage;
         struct_mumps.job = 2;
         CallMumps();
+	nb_retries++;
       }
     
     struct_mumps.icntl[13] = init_percentage;
@@ -69,11 +113,55 @@ namespace linalg
   }
   
   
+  //! Chooses in-core or out-of-core factorization from the estimates of the analysis
+  /*!
+    INFO(15) is the memory (in MB) estimated during the analysis for an
+    in-core factorization. If it exceeds the memory budget, the factorization
+    is performed out of core, and ICNTL(23) limits the memory allocated by Mumps.
+  */
+  template<class T>
+  void MatrixMumps<T>::PlanMemory()
+  {
+    struct_mumps.icntl[21] = out_of_core ? 1 : 0;
+    struct_mumps.icntl[22] = 0;
+    if (memory_budget > 0)
+      {
+	double mem_in_core = struct_mumps.info[14];
+	if (struct_mumps.info[14] < 0)
+	  mem_in_core = -1e6*struct_mumps.info[14];
+	
+	if (mem_in_core > memory_budget)
+	  struct_mumps.icntl[21] = 1;
+	
+	struct_mumps.icntl[22] = int(memory_budget);
+      }
+  }
+  
+  
+  //! Numerical factorization (the analysis has been performed)
+  template<class T>
+  void MatrixMumps<T>::FactorizeNumerically()
+  {
+    nb_retries = 0;
+    PlanMemory();
+    
+    struct_mumps.job = 2; // factorization only
+    CallMumps();
+    
+    IterateFacto();
+    CompleteSchurMatrix();
+  }
+  
+  
   //! Calls initialization routine provided by Mumps
   template<class T>
   void MatrixMumps<T>
   ::InitMatrix(bool sym, bool distributed)
   {
+    // queued right hand sides are solved with the previous factorization
+    if (struct_mumps.n > 0)
+      FlushSolve();
+
     // we clear previous factorization
     Clear();
 
@@ -98,6 +186,30 @@ namespace linalg
 
     struct_mumps.icntl[17] = 0;
 
+    // block low-rank factorization and solve
+    if (block_low_rank)
+      {
+	struct_mumps.icntl[34] = 2;
+	struct_mumps.icntl[35] = blr_variant;
+	struct_mumps.cntl[6] = blr_tolerance;
+      }
+    else
+      struct_mumps.icntl[34] = 0;
+
+    // Schur complement (centralized, stored by rows)
+    int size_schur = schur_var.GetM();
+    if (size_schur > 0)
+      {
+	struct_mumps.icntl[18] = 1;
+	struct_mumps.size_schur = size_schur;
+	struct_mumps.listvar_schur = schur_var.GetData();
+	schur_matrix.Reallocate(size_t(size_schur)*size_schur);
+	schur_matrix.Fill(T(0));
+	struct_mumps.schur = reinterpret_cast<pointer>(schur_matrix.GetData());
+      }
+    else
+      struct_mumps.icntl[18] = 0;
+
     // the print level is set in mumps
     if (print_level >= 0)
       {
@@ -133,9 +245,15 @@ namespace linalg
 
 
   //! Clears factorization
+  /*!
+    The queued right hand sides are discarded (the vectors may have been
+    destroyed already when Clear is called by the destructor), FlushSolve
+    must be called before if their solutions are needed.
+  */
   template<class T>
   void MatrixMumps<T>::Clear()
   {
+    queued_rhs.Clear();
     if (struct_mumps.n > 0)
       {
 	struct_mumps.job = -2;
@@ -144,6 +262,12 @@ namespace linalg
 
 	struct_mumps.n = 0;
       }
+
+    num_row.Clear();
+    num_col.Clear();
+    values.Clear();
+    block_rhs.Clear();
+    schur_matrix.Clear();
   }
 
 
@@ -190,6 +314,33 @@ namespace linalg
     out_of_core = false;
   }
 
+
+  //! Enables the block low-rank (BLR) factorization
+  /*!
+    \param[in] tolerance dropping parameter for the low-rank compression of
+    the blocks (CNTL(7)), the solution has roughly this relative accuracy
+    \param[in] variant 0 : compression after the factorization of the blocks
+    (UFSC), 1 : compression before (UCFS, faster but less accurate)
+    The factors are stored compressed and used in the solve phase. The
+    accuracy can be recovered by iterative refinement or by giving the
+    object as a preconditioner to an iterative solver.
+  */
+  template<class T>
+  void MatrixMumps<T>::EnableBlockLowRank(double tolerance, int variant)
+  {
+    block_low_rank = true;
+    blr_tolerance = tolerance;
+    blr_variant = variant;
+  }
+
+
+  //! Disables the block low-rank factorization (full-rank factors)
+  template<class T>
+  void MatrixMumps<T>::DisableBlockLowRank()
+  {
+    block_low_rank = false;
+  }
+
   
   //! Sets the coefficient used to overestimate the needed memory
   template<class T>
@@ -215,80 +366,262 @@ namespace linalg
   }
   
 
+  //! Converts a matrix in coordinate format with fortran convention (1-index)
+  /*!
+    \param[in] mat matrix to convert
+    \param[in] sym if true, only the upper part is stored
+    The result is stored in num_row, num_col and values
+  */
+  template<class T>
+  void MatrixMumps<T>::ConvertToCoordinate(const SparseMatrix<T>& mat, bool sym)
+  {
+    int nnz = 0;
+    for (int i = 0; i < mat.GetM(); i++)
+      for (int j = 0; j < mat.GetRowSize(i); j++)
+	if (!sym || (i <= mat.Index(i, j)))
+	  nnz++;
+    
+    num_row.Reallocate(nnz);
+    num_col.Reallocate(nnz);
+    values.Reallocate(nnz);
+    nnz = 0;
+    for (int i = 0; i < mat.GetM(); i++)
+      for (int j = 0; j < mat.GetRowSize(i); j++)
+	if (!sym || (i <= mat.Index(i, j)))
+	  {
+	    num_row(nnz) = i+1;
+	    num_col(nnz) = mat.Index(i, j) + 1;
+	    values(nnz) = mat.Value(i, j);
+	    nnz++;
+	  }
+    
+    struct_mumps.n = mat.GetM(); struct_mumps.nz = nnz;
+    struct_mumps.irn = num_row.GetData();
+    struct_mumps.jcn = num_col.GetData();
+    struct_mumps.a = reinterpret_cast<pointer>(values.GetData());
+  }
+  
+
   //! Factorizes a given matrix
   /*!
     \param[in,out] mat matrix to factorize
     \param[in] sym symmetric matrix ?
     \param[in] keep_matrix if false, the given matrix is cleared
+    The analysis is performed again, use Refactorize if only the values
+    of the matrix have changed
   */
   template<class T>
   void MatrixMumps<T>::Factorize(SparseMatrix<T>& mat, bool sym, bool keep_matrix)
   {
-    int n = mat.GetM();
-    // conversion in coordinate format with fortran convention (1-index)
-    Vector<int> num_row, num_col; Vector<T> values;
-    if (sym)
-      {
-	int nnz = 0;
-	for (int i = 0; i < mat.GetM(); i++)
-	  for (int j = 0; j < mat.GetRowSize(i); j++)
-	    if (i <= mat.Index(i, j))
-	      nnz ++;
-	
-	num_row.Reallocate(nnz);
-	num_col.Reallocate(nnz);
-	values.Reallocate(nnz);
-	nnz = 0;
-	for (int i = 0; i < mat.GetM(); i++)
-	  for (int j = 0; j < mat.GetRowSize(i); j++)
-	    if (i <= mat.Index(i, j))
-	      {
-		num_row(nnz) = i+1;
-		num_col(nnz) = mat.Index(i, j) + 1;
-		values(nnz) = mat.Value(i, j);
-		nnz++;
-	      }
-      }
-    else
-      {
-	int nnz = 0;
-	for (int i = 0; i < mat.GetM(); i++)
-	  nnz += mat.GetRowSize(i);
-	
-	num_row.Reallocate(nnz);
-	num_col.Reallocate(nnz);
-	values.Reallocate(nnz);
+    InitMatrix(sym);
+    ConvertToCoordinate(mat, sym);
+    
+    if (!keep_matrix)
+      mat.Clear();
+    
+    // the analysis gives the memory estimates used to plan the factorization
+    struct_mumps.job = 1;
+    CallMumps();
+    info_facto = struct_mumps.info[0];
+    if (info_facto < 0)
+      return;
+    
+    FactorizeNumerically();
+  }
 
-	nnz = 0;
-	for (int i = 0; i < mat.GetM(); i++)
-	  for (int j = 0; j < mat.GetRowSize(i); j++)
-	    {
-	      num_row(nnz) = i+1;
-	      num_col(nnz) = mat.Index(i, j) + 1;
-	      values(nnz) = mat.Value(i, j);
-	      nnz++;
-	    }
-	
+  
+  //! Performs the analysis (ordering and symbolic factorization) of a matrix
+  /*!
+    \param[in] mat matrix whose pattern is analysed
+    \param[in] sym symmetric matrix ?
+    The numerical factorization is then performed by Refactorize
+  */
+  template<class T>
+  void MatrixMumps<T>::Analyze(const SparseMatrix<T>& mat, bool sym)
+  {
+    InitMatrix(sym);
+    ConvertToCoordinate(mat, sym);
+    
+    struct_mumps.job = 1; // analysis only
+    CallMumps();
+    info_facto = struct_mumps.info[0];
+  }
+  
+  
+  //! Factorizes a matrix whose pattern is the one given to Analyze or Factorize
+  /*!
+    \param[in,out] mat matrix to factorize
+    \param[in] keep_matrix if false, the given matrix is cleared
+    The ordering, the symbolic analysis and the index arrays are kept, only
+    the values are updated. The pattern is assumed unchanged, only the number
+    of non-zero entries is checked (if it differs, a complete factorization
+    is performed).
+  */
+  template<class T>
+  void MatrixMumps<T>::Refactorize(SparseMatrix<T>& mat, bool keep_matrix)
+  {
+    bool sym = (struct_mumps.sym != 0);
+    int nnz = 0;
+    for (int i = 0; i < mat.GetM(); i++)
+      for (int j = 0; j < mat.GetRowSize(i); j++)
+	if (!sym || (i <= mat.Index(i, j)))
+	  nnz++;
+    
+    // queued right hand sides are solved with the previous factorization
+    FlushSolve();
+    
+    if ((struct_mumps.n != mat.GetM()) || (nnz != values.GetM()))
+      {
+	Factorize(mat, sym, keep_matrix);
+	return;
       }
-
+    
+    // same order as in ConvertToCoordinate
+    nnz = 0;
+    for (int i = 0; i < mat.GetM(); i++)
+      for (int j = 0; j < mat.GetRowSize(i); j++)
+	if (!sym || (i <= mat.Index(i, j)))
+	  values(nnz++) = mat.Value(i, j);
+    
     if (!keep_matrix)
       mat.Clear();
     
-    InitMatrix(sym);
+    FactorizeNumerically();
+  }
+  
+  
+  //! Sets the variables on which the Schur complement is computed
+  /*!
+    \param[in] num numbers of the Schur variables (0-index)
+    The Schur complement S = A22 - A21 A11^{-1} A12 (where 2 denotes the Schur
+    variables) is computed during the next call to Factorize or Analyze.
+    The factorization then concerns only A11 : Solve gives the solution with
+    zero Schur variables, CondenseRightHandSide and ExpandSolution must be
+    used to solve the complete system. An empty list disables the Schur complement.
+  */
+  template<class T>
+  void MatrixMumps<T>::SetSchurVariables(const Vector<int>& num)
+  {
+    schur_var.Reallocate(num.GetM());
+    for (int i = 0; i < num.GetM(); i++)
+      schur_var(i) = num(i) + 1;
+  }
+  
+  
+  //! Returns the number of Schur variables
+  template<class T>
+  int MatrixMumps<T>::GetSchurSize() const
+  {
+    return schur_var.GetM();
+  }
+  
+  
+  //! Returns the Schur complement (dense matrix stored by rows)
+  template<class T>
+  const Vector<T>& MatrixMumps<T>::GetSchurMatrix() const
+  {
+    return schur_matrix;
+  }
+  
+  
+  //! Fills the upper part of the Schur complement for symmetric matrices
+  /*!
+    For symmetric matrices, Mumps returns only the lower triangular part
+    (stored by rows)
+  */
+  template<class T>
+  void MatrixMumps<T>::CompleteSchurMatrix()
+  {
+    int ns = schur_var.GetM();
+    if ((ns == 0) || (struct_mumps.sym == 0))
+      return;
     
-    int nnz = values.GetM();
-    struct_mumps.n = n; struct_mumps.nz = nnz;
-    struct_mumps.irn = num_row.GetData();
-    struct_mumps.jcn = num_col.GetData();
-    struct_mumps.a = reinterpret_cast<pointer>(values.GetData());
-
-    // Call the MUMPS package.
-    struct_mumps.job = 4; // we analyse and factorize the system
+    for (int i = 0; i < ns; i++)
+      for (int j = 0; j < i; j++)
+	schur_matrix(size_t(ns)*j + i) = schur_matrix(size_t(ns)*i + j);
+  }
+  
+  
+  //! Computes the reduced right hand side on the Schur variables
+  /*!
+    \param[in,out] x right hand side on input, intermediate data on output
+    (it must be kept and given to ExpandSolution)
+    \param[out] b_schur reduced right hand side b2 - A21 A11^{-1} b1
+    The Schur system S x2 = b_schur is then solved by the user.
+  */
+  template<class T>
+  void MatrixMumps<T>::CondenseRightHandSide(Vector<T>& x, Vector<T>& b_schur)
+  {
+    int ns = schur_var.GetM();
+    b_schur.Reallocate(ns);
+    struct_mumps.icntl[8] = 1;
+    struct_mumps.icntl[25] = 1; // condensation phase
+    struct_mumps.nrhs = 1;
+    struct_mumps.lrhs = struct_mumps.n;
+    struct_mumps.lredrhs = ns;
+    struct_mumps.rhs = reinterpret_cast<pointer>(x.GetData());
+    struct_mumps.redrhs = reinterpret_cast<pointer>(b_schur.GetData());
+    struct_mumps.job = 3;
     CallMumps();
     
-    IterateFacto();
+    struct_mumps.icntl[25] = 0;
+  }
+  
+  
+  //! Computes the complete solution from the solution on the Schur variables
+  /*!
+    \param[in,out] x intermediate data computed by CondenseRightHandSide on
+    input, solution of the complete system on output
+    \param[in] x_schur solution of the Schur system S x2 = b_schur
+  */
+  template<class T>
+  void MatrixMumps<T>::ExpandSolution(Vector<T>& x, const Vector<T>& x_schur)
+  {
+    int ns = schur_var.GetM();
+    // copy since the pointer given to Mumps is not const
+    Vector<T> red(x_schur);
+    struct_mumps.icntl[8] = 1;
+    struct_mumps.icntl[25] = 2; // expansion phase
+    struct_mumps.nrhs = 1;
+    struct_mumps.lrhs = struct_mumps.n;
+    struct_mumps.lredrhs = ns;
+    struct_mumps.rhs = reinterpret_cast<pointer>(x.GetData());
+    struct_mumps.redrhs = reinterpret_cast<pointer>(red.GetData());
+    struct_mumps.job = 3;
+    CallMumps();
+    
+    struct_mumps.icntl[25] = 0;
+  }
+  
+  
+  //! Sets the memory budget in MB (0 for no limit)
+  /*!
+    If the memory estimated during the analysis exceeds the budget, the
+    factorization is performed out of core. The budget is given to Mumps
+    (ICNTL(23)), so that the workspace is allocated once without retries.
+  */
+  template<class T>
+  void MatrixMumps<T>::SetMemoryBudget(double mb)
+  {
+    memory_budget = mb;
   }
-
+  
+  
+  //! Returns the number of retried factorizations (memory too small) of the last factorization
+  template<class T>
+  int MatrixMumps<T>::GetNbRetries() const
+  {
+    return nb_retries;
+  }
+  
+  
+  //! Returns true if the current factorization is stored out of core
+  template<class T>
+  bool MatrixMumps<T>::UseOutOfCore() const
+  {
+    return (struct_mumps.icntl[21] == 1);
+  }
+  
   
   //! Returns memory used by the factorisation in bytes
   template<class T>
@@ -299,10 +632,35 @@ namespace linalg
     if (struct_mumps.n <= 0)
       return taille;
     
+    // arrays kept for Refactorize and Schur complement
+    taille += 2*sizeof(int)*num_row.GetM() + sizeof(T)*values.GetM();
+    taille += sizeof(T)*schur_matrix.GetM();
+    
     size_t nnz = struct_mumps.info[8];
     if (struct_mumps.info[8] < 0)
       nnz = abs(struct_mumps.info[8])*size_t(1024*1024);
 
+    // out of core, the factors are on the disk, INFO(17) is the memory (MB) used in core
+    if (struct_mumps.icntl[21] == 1)
+      {
+	double mem = struct_mumps.info[16];
+	if (struct_mumps.info[16] < 0)
+	  mem = -1e6*struct_mumps.info[16];
+	
+	return taille + size_t(mem*1e6);
+      }
+    
+    // with BLR, the effective number of entries of the compressed factors is used
+    if (block_low_rank && (struct_mumps.infog[28] != 0))
+      {
+	size_t nnz_full = nnz;
+	nnz = struct_mumps.infog[28];
+	if (struct_mumps.infog[28] < 0)
+	  nnz = abs(struct_mumps.infog[28])*size_t(1000*1000);
+	
+	nnz = min(nnz, nnz_full);
+      }
+
     taille += sizeof(T)*nnz ;
     nnz = struct_mumps.info[9];
     if (struct_mumps.info[9] < 0)
@@ -313,6 +671,32 @@ namespace linalg
   }
   
 
+  //! Returns the ratio between the entries of the compressed and full-rank factors
+  /*!
+    The ratio is equal to 1 if the BLR factorization is not enabled, the
+    memory used by the factors is approximately divided by the inverse of this ratio
+  */
+  template<class T>
+  double MatrixMumps<T>::GetCompressionRatio() const
+  {
+    if (!block_low_rank || (struct_mumps.n <= 0))
+      return 1.0;
+    
+    // INFOG(20) : estimated entries of full-rank factors, INFOG(29) : effective entries
+    double nnz_full = struct_mumps.infog[19], nnz = struct_mumps.infog[28];
+    if (struct_mumps.infog[19] < 0)
+      nnz_full = -1e6*struct_mumps.infog[19];
+    
+    if (struct_mumps.infog[28] < 0)
+      nnz = -1e6*struct_mumps.infog[28];
+    
+    if ((nnz_full <= 0) || (nnz <= 0))
+      return 1.0;
+    
+    return nnz/nnz_full;
+  }
+  
+  
   //! Returns information about factorization performed
   template<class T>
   int MatrixMumps<T>::GetInfoFactorization() const
@@ -328,28 +712,599 @@ namespace linalg
   */
   template<class T>
   void MatrixMumps<T>::Solve(Vector<T>& x)
+  {
+    SolveBlock(1, x);
+  }
+  
+  
+  //! Solves a linear system for several right hand sides at once
+  /*!
+    \param[in] nrhs number of right hand sides
+    \param[in,out] B right-hand-sides on input, solutions on output, stored
+    by columns (B(n*k + i) is the component i of the right hand side k)
+    The factors are traversed only once for all the right hand sides
+    (level 3 BLAS), which is much faster than nrhs calls to Solve.
+  */
+  template<class T>
+  void MatrixMumps<T>::SolveBlock(int nrhs, Vector<T>& B)
   {
 #ifdef LINALG_DEBUG
-    if (x.GetM() != struct_mumps.n)
-      throw WrongIndex("Mumps::Solve(TransA, c)",
-		       string("The length of x is equal to ")
-		       + to_string(x.GetM())
+    if (size_t(B.GetM()) != size_t(nrhs)*size_t(struct_mumps.n))
+      throw WrongIndex("Mumps::SolveBlock(nrhs, B)",
+		       string("The length of B is equal to ")
+		       + to_string(B.GetM())
 		       + " while the size of the matrix is equal to "
-		       + to_string(struct_mumps.n) + ".");
+		       + to_string(struct_mumps.n) + " and nrhs = "
+		       + to_string(nrhs) + ".");
 #endif
     
     // no transpose
     struct_mumps.icntl[8] = 1;
     
-    struct_mumps.nrhs = 1;
+    struct_mumps.nrhs = nrhs;
     struct_mumps.lrhs = struct_mumps.n;
-    struct_mumps.rhs = reinterpret_cast<pointer>(x.GetData());
+    struct_mumps.rhs = reinterpret_cast<pointer>(B.GetData());
     struct_mumps.job = 3; // we solve system
     CallMumps();
   }
+  
+  
+  //! Solves a linear system with a sparse right hand side
+  /*!
+    \param[in] b sparse right hand side
+    \param[out] x solution
+    Mumps exploits the sparsity of b during the forward substitution
+    (pruning of the elimination tree).
+  */
+  template<class T>
+  void MatrixMumps<T>::Solve(const SparseVector<T>& b, Vector<T>& x)
+  {
+    Vector<SparseVector<T> > B(1);
+    B(0) = b;
+    SolveBlock(B, x);
+  }
+  
+  
+  //! Solves a linear system for several sparse right hand sides
+  /*!
+    \param[in] B sparse right hand sides
+    \param[out] X solutions stored by columns (X(n*k + i) is the component i
+    of the solution k)
+  */
+  template<class T>
+  void MatrixMumps<T>::SolveBlock(const Vector<SparseVector<T> >& B, Vector<T>& X)
+  {
+    int nrhs = B.GetM(), n = struct_mumps.n;
+    
+    // right hand sides in compressed column format (1-index)
+    Vector<int> ptr(nrhs+1), ind;
+    Vector<T> val;
+    ptr(0) = 1;
+    for (int k = 0; k < nrhs; k++)
+      ptr(k+1) = ptr(k) + B(k).GetM();
+    
+    ind.Reallocate(ptr(nrhs)-1);
+    val.Reallocate(ptr(nrhs)-1);
+    for (int k = 0; k < nrhs; k++)
+      for (int j = 0; j < B(k).GetM(); j++)
+	{
+	  ind(ptr(k)-1+j) = B(k).Index(j) + 1;
+	  val(ptr(k)-1+j) = B(k).Value(j);
+	}
+    
+    X.Reallocate(size_t(n)*nrhs);
+    struct_mumps.icntl[8] = 1;
+    struct_mumps.icntl[19] = 1; // sparse right hand sides
+    struct_mumps.nrhs = nrhs;
+    struct_mumps.lrhs = n;
+    struct_mumps.nz_rhs = val.GetM();
+    struct_mumps.irhs_ptr = ptr.GetData();
+    struct_mumps.irhs_sparse = ind.GetData();
+    struct_mumps.rhs_sparse = reinterpret_cast<pointer>(val.GetData());
+    struct_mumps.rhs = reinterpret_cast<pointer>(X.GetData());
+    struct_mumps.job = 3;
+    CallMumps();
+    
+    struct_mumps.icntl[19] = 0;
+  }
+  
+  
+  //! Computes selected components of the solution of A x = b for a sparse b
+  /*!
+    \param[in] b sparse right hand side
+    \param[in] index components of the solution to compute
+    \param[out] x x(k) is the component index(k) of A^{-1} b
+    The needed entries of A^{-1} (rows index, columns of the non-zero
+    entries of b) are computed by GetInverseEntries, the cost is small when
+    both b and index contain a few entries.
+  */
+  template<class T>
+  void MatrixMumps<T>::Solve(const SparseVector<T>& b, const Vector<int>& index, Vector<T>& x)
+  {
+    int nb = index.GetM(), nnz = b.GetM();
+    Vector<int> row(nb*nnz), col(nb*nnz);
+    for (int k = 0; k < nb; k++)
+      for (int j = 0; j < nnz; j++)
+	{
+	  row(nnz*k + j) = index(k);
+	  col(nnz*k + j) = b.Index(j);
+	}
+    
+    Vector<T> val;
+    GetInverseEntries(row, col, val);
+    
+    x.Reallocate(nb);
+    for (int k = 0; k < nb; k++)
+      {
+	x(k) = T(0);
+	for (int j = 0; j < nnz; j++)
+	  x(k) += val(nnz*k + j)*b.Value(j);
+      }
+  }
+  
+  
+  //! Computes selected entries of the inverse of the factorized matrix
+  /*!
+    \param[in] row row numbers of the entries (0-index)
+    \param[in] col column numbers of the entries
+    \param[out] val val(k) is the entry (row(k), col(k)) of A^{-1}
+    Only the columns of A^{-1} containing requested entries are processed,
+    and the sparsity of the unit right hand sides is exploited.
+  */
+  template<class T>
+  void MatrixMumps<T>::GetInverseEntries(const Vector<int>& row, const Vector<int>& col,
+					 Vector<T>& val)
+  {
+    int n = struct_mumps.n, nb = row.GetM();
+    
+    // requested entries grouped by column (1-index)
+    Vector<int> ptr(n+1), ind(nb), pos(nb);
+    ptr.Zero();
+    for (int k = 0; k < nb; k++)
+      ptr(col(k)+1)++;
+    
+    ptr(0) = 1;
+    for (int j = 0; j < n; j++)
+      ptr(j+1) += ptr(j);
+    
+    Vector<int> nb_col(n);
+    nb_col.Zero();
+    for (int k = 0; k < nb; k++)
+      {
+	int j = col(k);
+	pos(k) = ptr(j) - 1 + nb_col(j);
+	ind(pos(k)) = row(k) + 1;
+	nb_col(j)++;
+      }
+    
+    Vector<T> entries(nb);
+    struct_mumps.icntl[29] = 1; // selected entries of the inverse
+    struct_mumps.nrhs = n;
+    struct_mumps.lrhs = n;
+    struct_mumps.nz_rhs = nb;
+    struct_mumps.irhs_ptr = ptr.GetData();
+    struct_mumps.irhs_sparse = ind.GetData();
+    struct_mumps.rhs_sparse = reinterpret_cast<pointer>(entries.GetData());
+    struct_mumps.job = 3;
+    CallMumps();
+    
+    struct_mumps.icntl[29] = 0;
+    val.Reallocate(nb);
+    for (int k = 0; k < nb; k++)
+      val(k) = entries(pos(k));
+  }
+  
+  
+  //! Sets the number of queued right hand sides triggering a block solve
+  template<class T>
+  void MatrixMumps<T>::SetBatchSize(int nb)
+  {
+    batch_size = nb;
+    if (queued_rhs.GetM() >= batch_size)
+      FlushSolve();
+  }
+  
+  
+  //! Returns the number of right hand sides not solved yet
+  template<class T>
+  int MatrixMumps<T>::GetNbQueuedSolves() const
+  {
+    return queued_rhs.GetM();
+  }
+  
+  
+  //! Adds a right hand side to the queue of systems to solve
+  /*!
+    \param[in,out] x right-hand-side on input, solution on output
+    The solution is available only after FlushSolve has been called, or when
+    the queue contains batch_size vectors (they are then solved together).
+    The vector x must not be modified or destroyed in the meantime.
+    A new factorization solves the queue first, but Clear and the destructor
+    discard it : FlushSolve must be called explicitly before.
+  */
+  template<class T>
+  void MatrixMumps<T>::AddSolve(Vector<T>& x)
+  {
+    queued_rhs.PushBack(&x);
+    if (queued_rhs.GetM() >= batch_size)
+      FlushSolve();
+  }
+  
+  
+  //! Solves all the queued right hand sides in a single block solve
+  template<class T>
+  void MatrixMumps<T>::FlushSolve()
+  {
+    int nrhs = queued_rhs.GetM();
+    if (nrhs == 0)
+      return;
+    
+    size_t n = struct_mumps.n;
+    block_rhs.Reallocate(n*nrhs);
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < nrhs; k++)
+      for (size_t i = 0; i < n; i++)
+	block_rhs(n*k + i) = (*queued_rhs(k))(i);
+    
+    SolveBlock(nrhs, block_rhs);
+    
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < nrhs; k++)
+      for (size_t i = 0; i < n; i++)
+	(*queued_rhs(k))(i) = block_rhs(n*k + i);
+    
+    queued_rhs.Clear();
+  }
+
+
+  //! Default constructor
+  template<class T>
+  MatrixMumpsMixed<T>::MatrixMumpsMixed()
+  {
+    mat_double = NULL;
+    epsilon = 1e-12;
+    nb_iter_max = 20;
+    nb_iter = 0;
+  }
+
+
+  //! Clears factorization
+  template<class T>
+  void MatrixMumpsMixed<T>::Clear()
+  {
+    mat_low.Clear();
+    mat_double = NULL;
+    xlow.Clear(); rhs.Clear(); res.Clear(); dx.Clear();
+  }
+
+
+  //! Returns the single precision solver (to modify its parameters)
+  template<class T>
+  MatrixMumps<typename TypeMumps<T>::low_precision>& MatrixMumpsMixed<T>::GetSinglePrecisionSolver()
+  {
+    return mat_low;
+  }
+
+
+  //! Sets the stopping criterion (on |b - A x| / |b|) and the maximal number of iterations
+  template<class T>
+  void MatrixMumpsMixed<T>::SetRefinementParameters(double eps, int nb_max)
+  {
+    epsilon = eps;
+    nb_iter_max = nb_max;
+  }
+
+
+  //! Returns the number of iterations (refinement + GMRES) of the last solve
+  template<class T>
+  int MatrixMumpsMixed<T>::GetNbIterations() const
+  {
+    return nb_iter;
+  }
+
+
+  //! Factorizes a given matrix in single precision
+  /*!
+    \param[in] mat matrix to factorize, it is used to compute residuals in Solve
+    and must not be modified or destroyed while the factorization is used
+    \param[in] sym symmetric matrix ?
+  */
+  template<class T>
+  void MatrixMumpsMixed<T>::Factorize(const SparseMatrix<T>& mat, bool sym)
+  {
+    int n = mat.GetM();
+    SparseMatrix<Tlow> mat_single(n, mat.GetN());
+    for (int i = 0; i < n; i++)
+      {
+	mat_single.ReallocateRow(i, mat.GetRowSize(i));
+	for (int j = 0; j < mat.GetRowSize(i); j++)
+	  {
+	    mat_single.Index(i, j) = mat.Index(i, j);
+	    mat_single.Value(i, j) = Tlow(mat.Value(i, j));
+	  }
+      }
+
+    mat_low.Factorize(mat_single, sym);
+    mat_double = &mat;
+  }
+
+
+  //! Applies the single precision factorization : z = A^{-1} r (single precision accuracy)
+  template<class T>
+  void MatrixMumpsMixed<T>::Solve(const Vector<T>& r, Vector<T>& z)
+  {
+    int n = r.GetM();
+    xlow.Reallocate(n);
+    for (int i = 0; i < n; i++)
+      xlow(i) = Tlow(r(i));
+
+    mat_low.Solve(xlow);
+    z.Reallocate(n);
+    for (int i = 0; i < n; i++)
+      z(i) = T(xlow(i));
+  }
+
+
+  //! Solves a linear system with the accuracy of double precision
+  /*!
+    \param[in,out] x right-hand-side on input, solution on output
+    Iterative refinement x = x + A^{-1} (b - A x) is performed with the single
+    precision factorization. If the residual is not divided by two at an
+    iteration, the remaining iterations are done with GMRES.
+  */
+  template<class T>
+  void MatrixMumpsMixed<T>::Solve(Vector<T>& x)
+  {
+    rhs = x;
+    double norm_b = abs(Norm2(rhs));
+    if (norm_b == 0)
+      norm_b = 1;
+
+    Solve(rhs, x);
+    double norm_r, norm_prev = 0;
+    nb_iter = 0;
+    while (nb_iter < nb_iter_max)
+      {
+	res = rhs;
+	mat_double->MltAdd(T(-1), x, res);
+	norm_r = abs(Norm2(res))/norm_b;
+	if (norm_r <= epsilon)
+	  break;
+
+	if ((nb_iter > 0) && (norm_r > 0.5*norm_prev))
+	  {
+	    // the refinement stagnates (ill-conditioned matrix)
+	    gmres.Solve(*mat_double, x, rhs, *this, epsilon, nb_iter_max - nb_iter);
+	    nb_iter += gmres.GetNbIterations();
+	    break;
+	  }
+
+	Solve(res, dx);
+	Add(T(1), dx, x);
+	norm_prev = norm_r;
+	nb_iter++;
+      }
+  }
+
+
+
+  //! Default constructor
+  template<class T>
+  MumpsFactorizationCache<T>::MumpsFactorizationCache()
+  {
+    max_size = 8;
+    memory_budget = 0;
+    out_of_core = false;
+    nb_hits = 0;
+    nb_misses = 0;
+    info_facto = 0;
+  }
+
+
+  //! Destructor
+  template<class T>
+  MumpsFactorizationCache<T>::~MumpsFactorizationCache()
+  {
+    Clear();
+  }
+
+
+  //! Destroys all the factorizations
+  template<class T>
+  void MumpsFactorizationCache<T>::Clear()
+  {
+    for (int k = 0; k < factorizations.GetM(); k++)
+      delete factorizations(k);
+
+    factorizations.Clear();
+    hash_values.Clear();
+    nnz_matrices.Clear();
+    sym_matrices.Clear();
+  }
+
+
+  //! Destroys the factorization k
+  template<class T>
+  void MumpsFactorizationCache<T>::Remove(int k)
+  {
+    delete factorizations(k);
+    int nb = factorizations.GetM();
+    for (int j = k; j < nb-1; j++)
+      {
+	factorizations(j) = factorizations(j+1);
+	hash_values(j) = hash_values(j+1);
+	nnz_matrices(j) = nnz_matrices(j+1);
+	sym_matrices(j) = sym_matrices(j+1);
+      }
+
+    factorizations.Resize(nb-1);
+    hash_values.Resize(nb-1);
+    nnz_matrices.Resize(nb-1);
+    sym_matrices.Resize(nb-1);
+  }
+
+
+  //! Sets the maximal number of stored factorizations
+  template<class T>
+  void MumpsFactorizationCache<T>::SetMaxSize(int nb)
+  {
+    max_size = nb;
+  }
+
+
+  //! Sets the maximal memory (in MB) used by the stored factorizations (0 for no limit)
+  template<class T>
+  void MumpsFactorizationCache<T>::SetMemoryBudget(double mb)
+  {
+    memory_budget = mb;
+  }
+
+
+  //! The next factorizations will be stored on the disk
+  /*!
+    Only the in-core part of the factorizations is then counted in the
+    memory budget, more factorizations can be kept
+  */
+  template<class T>
+  void MumpsFactorizationCache<T>::EnableOutOfCore()
+  {
+    out_of_core = true;
+  }
+
+
+  //! The next factorizations will be stored in memory
+  template<class T>
+  void MumpsFactorizationCache<T>::DisableOutOfCore()
+  {
+    out_of_core = false;
+  }
+
+
+  //! Returns the number of stored factorizations
+  template<class T>
+  int MumpsFactorizationCache<T>::GetSize() const
+  {
+    return factorizations.GetM();
+  }
+
+
+  //! Returns the number of calls to Factorize where the factorization was found
+  template<class T>
+  int MumpsFactorizationCache<T>::GetNbHits() const
+  {
+    return nb_hits;
+  }
+
+
+  //! Returns the number of calls to Factorize where a factorization was performed
+  template<class T>
+  int MumpsFactorizationCache<T>::GetNbMisses() const
+  {
+    return nb_misses;
+  }
+
+
+  //! Returns the memory used by the stored factorizations in bytes
+  template<class T>
+  size_t MumpsFactorizationCache<T>::GetMemorySize() const
+  {
+    size_t taille = sizeof(*this);
+    for (int k = 0; k < factorizations.GetM(); k++)
+      taille += factorizations(k)->GetMemorySize();
+
+    return taille;
+  }
+
+
+  //! Returns INFO(1) of the last call to Factorize (negative if Mumps failed)
+  template<class T>
+  int MumpsFactorizationCache<T>::GetInfoFactorization() const
+  {
+    return info_facto;
+  }
+
+
+  //! Returns the factorization of a matrix, computed only if it is not stored
+  /*!
+    \param[in,out] mat matrix to factorize
+    \param[in] sym symmetric matrix ?
+    \param[in] keep_matrix if false, the given matrix is cleared
+    The returned object belongs to the cache, it remains valid until the next
+    call to Factorize or Clear. If Mumps fails, the cache is left unchanged,
+    GetInfoFactorization returns the error and the returned object contains
+    no factorization.
+  */
+  template<class T>
+  MatrixMumps<T>& MumpsFactorizationCache<T>::Factorize(SparseMatrix<T>& mat, bool sym,
+							 bool keep_matrix)
+  {
+    uint64_t hash = GetHashValue(mat);
+    size_t nnz = 0;
+    for (int i = 0; i < mat.GetM(); i++)
+      nnz += mat.GetRowSize(i);
+
+    int nb = factorizations.GetM();
+    for (int k = nb-1; k >= 0; k--)
+      if ((hash_values(k) == hash) && (nnz_matrices(k) == nnz) && (sym_matrices(k) == sym))
+	{
+	  // the factorization becomes the most recently used
+	  MatrixMumps<T>* facto = factorizations(k);
+	  for (int j = k; j < nb-1; j++)
+	    {
+	      factorizations(j) = factorizations(j+1);
+	      hash_values(j) = hash_values(j+1);
+	      nnz_matrices(j) = nnz_matrices(j+1);
+	      sym_matrices(j) = sym_matrices(j+1);
+	    }
+
+	  factorizations(nb-1) = facto;
+	  hash_values(nb-1) = hash;
+	  nnz_matrices(nb-1) = nnz;
+	  sym_matrices(nb-1) = sym;
+
+	  nb_hits++;
+	  info_facto = 0;
+	  if (!keep_matrix)
+	    mat.Clear();
+
+	  return *facto;
+	}
+
+    nb_misses++;
+    MatrixMumps<T>* facto = new MatrixMumps<T>();
+    if (out_of_core)
+      facto->EnableOutOfCore();
+
+    facto->Factorize(mat, sym, keep_matrix);
+    info_facto = facto->GetInfoFactorization();
+    if (info_facto < 0)
+      {
+	// a failed factorization is not stored in the cache
+	delete facto;
+	return no_facto;
+      }
+
+    factorizations.PushBack(facto);
+    hash_values.PushBack(hash);
+    nnz_matrices.PushBack(nnz);
+    sym_matrices.PushBack(sym);
+
+    // the least recently used factorizations are removed (the new one is kept)
+    while ((factorizations.GetM() > 1) && ((factorizations.GetM() > max_size)
+	   || ((memory_budget > 0) && (GetMemorySize() > memory_budget*1e6))))
+      Remove(0);
+
+    return *facto;
+  }
 
+  template class MatrixMumps<float>;
+  template class MatrixMumps<complex<float> >;
   template class MatrixMumps<double>;
   template class MatrixMumps<complex<double> >;
+  template class MatrixMumpsMixed<double>;
+  template class MatrixMumpsMixed<complex<double> >;
+  template class MumpsFactorizationCache<double>;
+  template class MumpsFactorizationCache<complex<double> >;
   
 }
 
@@ -3,7 +3,9 @@
 // including Mumps headers
 extern "C"
 {
+#include "smumps_c.h"
 #include "dmumps_c.h"
+#include "cmumps_c.h"
 #include "zmumps_c.h"
 }
 
@@ -15,6 +17,26 @@ namespace linalg
   };
 
 
+  //! class containing MUMPS data structure
+  template<>
+  class TypeMumps<float>
+  {
+  public :
+    typedef SMUMPS_STRUC_C data;
+    typedef float* pointer;
+  };
+
+
+  //! class containing MUMPS data structure
+  template<>
+  class TypeMumps<complex<float> >
+  {
+  public :
+    typedef CMUMPS_STRUC_C data;
+    typedef mumps_complex* pointer;
+  };
+
+
   //! class containing MUMPS data structure
   template<>
   class TypeMumps<double>
@@ -22,6 +44,8 @@ namespace linalg
   public :
     typedef DMUMPS_STRUC_C data;
     typedef double* pointer;
+    //! type used for a single precision factorization
+    typedef float low_precision;
   };
 
 
@@ -32,6 +56,8 @@ namespace linalg
   public :
     typedef ZMUMPS_STRUC_C data;
     typedef mumps_double_complex* pointer;
+    //! type used for a single precision factorization
+    typedef complex<float> low_precision;
   };
 
 
@@ -51,12 +77,33 @@ namespace linalg
     double coef_overestimate;
     double coef_increase_memory;
     double coef_max_overestimate;
+    //! memory budget in MB (0 : no limit) and number of retried factorizations
+    double memory_budget;
+    int nb_retries;
+    //! block low-rank factorization
+    bool block_low_rank;
+    double blr_tolerance;
+    int blr_variant;
+    //! matrix in coordinate format (1-index), kept for Refactorize
+    Vector<int> num_row, num_col;
+    Vector<T> values;
+    //! right hand sides waiting to be solved together
+    int batch_size;
+    Vector<Vector<T>*> queued_rhs;
+    Vector<T> block_rhs;
+    //! Schur variables (1-index) and Schur complement (stored by rows)
+    Vector<int> schur_var;
+    Vector<T> schur_matrix;
 
     // internal methods
     void CallMumps();
     void IterateFacto();
+    void PlanMemory();
+    void FactorizeNumerically();
     
     void InitMatrix(bool sym, bool dist = false);
+    void ConvertToCoordinate(const SparseMatrix<T>& mat, bool sym);
+    void CompleteSchurMatrix();
 
   public :
     MatrixMumps();
@@ -70,18 +117,143 @@ namespace linalg
     void SelectOrdering(int num_ordering);
     void EnableOutOfCore();
     void DisableOutOfCore();
+
+    void EnableBlockLowRank(double tolerance, int variant = 0);
+    void DisableBlockLowRank();
     
     void SetCoefficientEstimationNeededMemory(double);
     void SetMaximumCoefficientEstimationNeededMemory(double);
     void SetIncreaseCoefficientEstimationNeededMemory(double);
+    void SetMemoryBudget(double mb);
+
+    int GetNbRetries() const;
+    bool UseOutOfCore() const;
 
     size_t GetMemorySize() const;
+    double GetCompressionRatio() const;
     int GetInfoFactorization() const;
 
     void Factorize(SparseMatrix<T> & mat, bool sym,
 		   bool keep_matrix = false);
 
+    void Analyze(const SparseMatrix<T>& mat, bool sym);
+    void Refactorize(SparseMatrix<T>& mat, bool keep_matrix = false);
+
+    void SetSchurVariables(const Vector<int>& num);
+    int GetSchurSize() const;
+    const Vector<T>& GetSchurMatrix() const;
+    void CondenseRightHandSide(Vector<T>& x, Vector<T>& b_schur);
+    void ExpandSolution(Vector<T>& x, const Vector<T>& x_schur);
+
     void Solve(Vector<T>& x);
+    void SolveBlock(int nrhs, Vector<T>& B);
+
+    void Solve(const SparseVector<T>& b, Vector<T>& x);
+    void SolveBlock(const Vector<SparseVector<T> >& B, Vector<T>& X);
+    void Solve(const SparseVector<T>& b, const Vector<int>& index, Vector<T>& x);
+    void GetInverseEntries(const Vector<int>& row, const Vector<int>& col, Vector<T>& val);
+
+    void SetBatchSize(int nb);
+    int GetNbQueuedSolves() const;
+    void AddSolve(Vector<T>& x);
+    void FlushSolve();
+  };
+
+
+  //! Mixed-precision solver : factorization in single precision, solution in double precision
+  /*!
+    The matrix is factorized by Mumps in single precision (half the memory of
+    the factors), the accuracy of double precision is recovered by iterative
+    refinement with residuals computed in double precision. If the refinement
+    stagnates, GMRES preconditioned by the single precision factorization is
+    used. The object can also be given as a preconditioner to an iterative solver.
+   */
+  template<class T>
+  class MatrixMumpsMixed : public VirtualPreconditioner<T>
+  {
+  protected :
+    //! float or complex<float>
+    typedef typename TypeMumps<T>::low_precision Tlow;
+    //! factorization in single precision
+    MatrixMumps<Tlow> mat_low;
+    //! matrix in double precision (not copied, it must stay alive)
+    const SparseMatrix<T>* mat_double;
+    //! stopping criterion and maximal number of iterations for the refinement
+    double epsilon;
+    int nb_iter_max;
+    //! number of iterations of the last solve
+    int nb_iter;
+    //! work vectors
+    Vector<Tlow> xlow;
+    Vector<T> rhs, res, dx;
+    GmresSolver<T> gmres;
+
+  public :
+    MatrixMumpsMixed();
+
+    void Clear();
+    MatrixMumps<Tlow>& GetSinglePrecisionSolver();
+
+    void SetRefinementParameters(double eps, int nb_max);
+    int GetNbIterations() const;
+
+    void Factorize(const SparseMatrix<T>& mat, bool sym);
+
+    void Solve(const Vector<T>& r, Vector<T>& z);
+    void Solve(Vector<T>& x);
+  };
+
+
+
+  //! Cache of factorizations, a matrix already factorized is not factorized again
+  /*!
+    The matrices are identified by a hash of their pattern and values
+    (GetHashValue), the sizes and the symmetry. The least recently used
+    factorizations are destroyed when the number of factorizations or the
+    memory used exceeds the given limits.
+   */
+  template<class T>
+  class MumpsFactorizationCache
+  {
+  protected :
+    //! cached factorizations (the most recently used is the last one)
+    Vector<MatrixMumps<T>*> factorizations;
+    //! hash, number of non-zero entries and symmetry of the factorized matrices
+    Vector<uint64_t> hash_values;
+    Vector<size_t> nnz_matrices;
+    Vector<bool> sym_matrices;
+    //! maximal number of factorizations
+    int max_size;
+    //! maximal memory in MB (0 : no limit)
+    double memory_budget;
+    //! if true, the factors are stored on the disk
+    bool out_of_core;
+    int nb_hits, nb_misses;
+    //! INFO(1) of the last call to Factorize (0 if no error)
+    int info_facto;
+    //! empty object returned by Factorize when the factorization fails
+    MatrixMumps<T> no_facto;
+
+    void Remove(int k);
+
+  public :
+    MumpsFactorizationCache();
+    ~MumpsFactorizationCache();
+
+    void Clear();
+
+    void SetMaxSize(int nb);
+    void SetMemoryBudget(double mb);
+    void EnableOutOfCore();
+    void DisableOutOfCore();
+
+    int GetSize() const;
+    int GetNbHits() const;
+    int GetNbMisses() const;
+    size_t GetMemorySize() const;
+    int GetInfoFactorization() const;
+
+    MatrixMumps<T>& Factorize(SparseMatrix<T>& mat, bool sym, bool keep_matrix = false);
   };
 
 }
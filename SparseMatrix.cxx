@@ -1,6 +1,7 @@
 #ifndef LINALG_FILE_SPARSE_MATRIX_CXX
 
 #include "SparseMatrix.hxx"
+#include "Ordering.hxx"
 
 namespace linalg
 {
@@ -43,10 +44,32 @@ namespace linalg
     abort();
   }
   
+  //! Effectue le produit Y = A X pour nrhs vecteurs
+  /*!
+    Les vecteurs sont entrelaces : X(nrhs*i + k) est la composante i du
+    vecteur k. Par defaut, on fait un produit matrice-vecteur par colonne.
+   */
+  template<class T>
+  void VirtualMatrix<T>::MltBlock(int nrhs, const Vector<T>& X, Vector<T>& Y) const
+  {
+    Vector<T> x(n_), y(m_);
+    Y.Reallocate(size_t(nrhs)*m_);
+    for (int k = 0; k < nrhs; k++)
+      {
+	for (int i = 0; i < n_; i++)
+	  x(i) = X(size_t(nrhs)*i + k);
+	
+	Mlt(x, y);
+	for (int i = 0; i < m_; i++)
+	  Y(size_t(nrhs)*i + k) = y(i);
+      }
+  }
+  
   //! Constructeur par defaut
   template<class T>
   SparseMatrix<T>::SparseMatrix()
   {
+    pattern_frozen_ = false;
   }
   
   //! Constructeur avec le nombre de lignes et colonnes
@@ -56,6 +79,7 @@ namespace linalg
     this->m_ = m;
     this->n_ = n;
     val_.Reallocate(m);
+    pattern_frozen_ = false;
   }
 
   //! Change le nombre de lignes et colonnes de la matrice
@@ -65,6 +89,8 @@ namespace linalg
     this->m_ = m;
     this->n_ = n;
     val_.Reallocate(m);
+    pattern_frozen_ = false;
+    ClearColoring();
   }
   
   //! Efface la matrice
@@ -74,6 +100,8 @@ namespace linalg
     this->m_ = 0;
     this->n_ = 0;
     val_.Clear();
+    pattern_frozen_ = false;
+    ClearColoring();
   }
   
   //! Retourne le nombre d'elements non-nuls de la ligne i
@@ -88,6 +116,7 @@ namespace linalg
   void SparseMatrix<T>::ReallocateRow(int i, int n)
   {
     val_(i).Reallocate(n);
+    ClearColoring();
   }
   
   //! Efface la ligne i
@@ -95,6 +124,19 @@ namespace linalg
   void SparseMatrix<T>::ClearRow(int i)
   {
     val_(i).Clear();
+    ClearColoring();
+  }
+  
+  //! Change le nombre d'elements non-nuls de la ligne i sans effacer le coloriage
+  /*!
+    Seule la ligne i est modifiee, si bien que des lignes differentes peuvent
+    etre redimensionnees en parallele. L'appelant efface le coloriage une fois
+    avant la boucle.
+   */
+  template<class T>
+  inline void SparseMatrix<T>::ResizeRow(int i, int n)
+  {
+    val_(i).Reallocate(n);
   }
     
   //! Renvoie le numero de colonne de l'element non-nul j de la ligne i
@@ -159,17 +201,85 @@ namespace linalg
 		       + to_string(this->m_) + " x " + to_string(this->n_) + ".");
 #endif
     
-    val_(i).AddInteraction(j, x);
+    if (pattern_frozen_)
+      {
+	// structure figee : on ajoute x a la valeur existante
+	int k = val_(i).FindIndex(j);
+	if (k < 0)
+	  throw WrongIndex("SparseMatrix::AddInteraction",
+			   string("A(") + to_string(i) + ", " + to_string(j)
+			   + ") is not in the frozen pattern of the matrix.");
+	
+	val_(i).Value(k) += x;
+      }
+    else
+      {
+	int size = val_(i).GetM();
+	val_(i).AddInteraction(j, x);
+	
+	// un nouvel element invalide le coloriage
+	if (val_(i).GetM() != size)
+	  ClearColoring();
+      }
+  }
+
+  //! Renvoie la position de A(i, j) dans la ligne i (-1 si A(i, j) n'est pas stocke)
+  /*!
+    Cette position peut etre conservee pour ajouter directement des valeurs
+    avec Value(i, k) tant que la structure de la matrice n'est pas modifiee
+   */
+  template<class T>
+  inline int SparseMatrix<T>::FindIndex(int i, int j) const
+  {
+    return val_(i).FindIndex(j);
+  }
+
+  //! Fige la structure de la matrice
+  /*!
+    Les appels suivants a AddInteraction ne font qu'une recherche dichotomique
+    dans la ligne et ajoutent la valeur, sans insertion ni reallocation.
+    Ajouter un element hors de la structure declenche une erreur.
+    Combinee avec ZeroValues, cela permet de reassembler une matrice
+    de meme structure a chaque pas de temps.
+   */
+  template<class T>
+  void SparseMatrix<T>::FreezePattern()
+  {
+    pattern_frozen_ = true;
+  }
+
+  //! Autorise de nouveau AddInteraction a modifier la structure de la matrice
+  template<class T>
+  void SparseMatrix<T>::UnfreezePattern()
+  {
+    pattern_frozen_ = false;
+  }
+
+  //! Renvoie true si la structure de la matrice est figee
+  template<class T>
+  inline bool SparseMatrix<T>::IsPatternFrozen() const
+  {
+    return pattern_frozen_;
+  }
+
+  //! Met toutes les valeurs a 0 en conservant la structure
+  template<class T>
+  void SparseMatrix<T>::ZeroValues()
+  {
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < this->GetM(); i++)
+      for (int j = 0; j < this->GetRowSize(i); j++)
+	this->Value(i, j) = T(0);
   }
 
   //! Effectue le produit matrice-vecteur y = A x
   template<class T>
   void SparseMatrix<T>::Mlt(const Vector<T>& x, Vector<T>& y) const
   {
-    T val;
+#pragma omp parallel for schedule(static)
     for (int i = 0; i < this->GetM(); i++)
       {
-	val = 0;
+	T val = 0;
 	for (int j = 0; j < this->GetRowSize(i); j++)
 	  val += this->Value(i, j)*x(this->Index(i, j));
 	
@@ -183,72 +293,338 @@ namespace linalg
     template<class T>
     void SparseMatrix<T>::AddM(const SparseMatrix<T>& B, SparseMatrix<T>& C) const
     {
-        if (this->GetM() != B.GetM() || this->GetN() != B.GetN())
+        Add(T(1), *this, T(1), B, C);
+    }
+
+    //! Multiplie la matrice par val et stocke le resultat dans B
+    template<class T>
+    void SparseMatrix<T>::MltConst(const T& val, SparseMatrix<T>& B)
+    {
+        B = *this;
+        B *= val;
+    }
+
+    //! Multiplie la matrice par alpha (la structure est conservee)
+    template<class T>
+    SparseMatrix<T>& SparseMatrix<T>::operator*=(const T& alpha)
+    {
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < this->GetM(); i++)
+            for (int j = 0; j < this->GetRowSize(i); j++)
+                this->Value(i, j) *= alpha;
+
+        return *this;
+    }
+
+    //! Construit dans C la structure de A + B (les valeurs sont mises a 0)
+    /*!
+      Chaque ligne de C est obtenue par fusion des lignes (triees) de A et B
+      et n'est allouee qu'une fois. Cette etape symbolique peut etre faite
+      une seule fois, les valeurs etant ensuite calculees avec AddNumeric.
+     */
+    template<class T>
+    void AddSymbolic(const SparseMatrix<T>& A, const SparseMatrix<T>& B, SparseMatrix<T>& C)
+    {
+        if (A.GetM() != B.GetM() || A.GetN() != B.GetN())
         {
             cout << "les matrices doivent etre de meme taille" << endl;
             abort();
         }
-        
+
+        // Clear efface aussi le coloriage de C, les lignes sont ensuite
+        // redimensionnees en parallele par ResizeRow
         C.Clear();
-        C.Reallocate(B.GetM(), B.GetN());
-        
-        for (int i=0; i < B.GetN(); i++)
+        C.Reallocate(A.GetM(), A.GetN());
+
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int i = 0; i < A.GetM(); i++)
         {
-            for (int j=0; j<this->GetRowSize(i); j++)
-                C.AddInteraction(i, this->Index(i,j), this->Value(i,j));
-            
-            for (int j=0; j<B.GetRowSize(i); j++)
-                C.AddInteraction(i, B.Index(i,j), B.Value(i,j));
-            
+            int size_a = A.GetRowSize(i), size_b = B.GetRowSize(i);
+
+            // nombre d'elements de l'union
+            int ja = 0, jb = 0, nb = 0;
+            while (ja < size_a || jb < size_b)
+            {
+                if (jb == size_b || (ja < size_a && A.Index(i, ja) < B.Index(i, jb)))
+                    ja++;
+                else if (ja == size_a || B.Index(i, jb) < A.Index(i, ja))
+                    jb++;
+                else
+                {
+                    ja++;
+                    jb++;
+                }
+
+                nb++;
+            }
+
+            C.ResizeRow(i, nb);
+            ja = 0; jb = 0; nb = 0;
+            while (ja < size_a || jb < size_b)
+            {
+                if (jb == size_b || (ja < size_a && A.Index(i, ja) < B.Index(i, jb)))
+                    C.Index(i, nb) = A.Index(i, ja++);
+                else if (ja == size_a || B.Index(i, jb) < A.Index(i, ja))
+                    C.Index(i, nb) = B.Index(i, jb++);
+                else
+                {
+                    C.Index(i, nb) = A.Index(i, ja++);
+                    jb++;
+                }
+
+                C.Value(i, nb) = T(0);
+                nb++;
+            }
         }
     }
 
-    //! Multiplie la matrice par val et stocke le resultat dans B
+    //! Calcule les valeurs de C = alpha A + beta B
+    /*!
+      La structure de C doit contenir celles de A et de B (par exemple en ayant
+      appele AddSymbolic auparavant), seules les valeurs de C sont modifiees.
+     */
     template<class T>
-    void SparseMatrix<T>::MltConst(const T& val, SparseMatrix<T>& B)
+    void AddNumeric(const T& alpha, const SparseMatrix<T>& A,
+                    const T& beta, const SparseMatrix<T>& B, SparseMatrix<T>& C)
     {
-        B.Clear();
-        B.Reallocate(this->GetM(), this->GetN());
-        for (int i=0; i < this->GetN(); i++)
+        if (A.GetM() != B.GetM() || A.GetN() != B.GetN()
+            || A.GetM() != C.GetM() || A.GetN() != C.GetN())
         {
-            for (int j=0; j<this->GetRowSize(i); j++)
-                B.AddInteraction(i,j, this->Value(i,j)*val);
+            cout << "les matrices doivent etre de meme taille" << endl;
+            abort();
+        }
+
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int i = 0; i < C.GetM(); i++)
+        {
+            int ja = 0, jb = 0;
+            for (int k = 0; k < C.GetRowSize(i); k++)
+            {
+                int col = C.Index(i, k);
+                T val(0);
+                if (ja < A.GetRowSize(i) && A.Index(i, ja) == col)
+                    val += alpha*A.Value(i, ja++);
+
+                if (jb < B.GetRowSize(i) && B.Index(i, jb) == col)
+                    val += beta*B.Value(i, jb++);
+
+                C.Value(i, k) = val;
+            }
+
+            if (ja < A.GetRowSize(i) || jb < B.GetRowSize(i))
+                throw WrongIndex("AddNumeric(alpha, A, beta, B, C)",
+                                 string("The pattern of C does not contain the patterns")
+                                 + " of A and B on row " + to_string(i) + ".");
+        }
+    }
+
+    //! Calcule C = alpha A + beta B
+    template<class T>
+    void Add(const T& alpha, const SparseMatrix<T>& A,
+             const T& beta, const SparseMatrix<T>& B, SparseMatrix<T>& C)
+    {
+        AddSymbolic(A, B, C);
+        AddNumeric(alpha, A, beta, B, C);
+    }
+
+    //! Calcule A = A + alpha B
+    /*!
+      Si la structure de B est incluse dans celle de A, seules les valeurs de A
+      sont mises a jour. Sinon la structure de A est elargie a celle de A + B,
+      ce qui declenche une erreur si la structure de A est figee.
+     */
+    template<class T>
+    void Add(const T& alpha, const SparseMatrix<T>& B, SparseMatrix<T>& A)
+    {
+        if (A.GetM() != B.GetM() || A.GetN() != B.GetN())
+        {
+            cout << "les matrices doivent etre de meme taille" << endl;
+            abort();
+        }
+
+        // on verifie que la structure de B est incluse dans celle de A
+        bool included = true;
+        int i_out = 0, j_out = 0;
+        for (int i = 0; i < A.GetM(); i++)
+        {
+            int ja = 0;
+            for (int jb = 0; jb < B.GetRowSize(i); jb++)
+            {
+                while (ja < A.GetRowSize(i) && A.Index(i, ja) < B.Index(i, jb))
+                    ja++;
+
+                if (ja == A.GetRowSize(i) || A.Index(i, ja) != B.Index(i, jb))
+                {
+                    included = false;
+                    i_out = i;
+                    j_out = B.Index(i, jb);
+                    break;
+                }
+            }
+
+            if (!included)
+                break;
+        }
+
+        if (!included)
+        {
+            // une structure figee ne peut pas etre elargie
+            if (A.IsPatternFrozen())
+                throw WrongIndex("Add(alpha, B, A)",
+                                 string("A(") + to_string(i_out) + ", " + to_string(j_out)
+                                 + ") is not in the frozen pattern of the matrix.");
+
+            SparseMatrix<T> C;
+            Add(T(1), A, alpha, B, C);
+            A = C;
+            return;
+        }
+
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int i = 0; i < A.GetM(); i++)
+        {
+            int ja = 0;
+            for (int jb = 0; jb < B.GetRowSize(i); jb++)
+            {
+                while (A.Index(i, ja) < B.Index(i, jb))
+                    ja++;
+
+                A.Value(i, ja) += alpha*B.Value(i, jb);
+            }
         }
     }
-    
-    
 
-    
     //! Effectue le produit matrice-matrice M = A B
+    /*!
+      Algorithme de Gustavson : la ligne i de AB est la combinaison des lignes
+      de B ponderees par les elements de la ligne i de A. Les contributions sont
+      accumulees en reperant la position de chaque colonne dans un tableau
+      dense (un par thread), puis les numeros de colonne sont tries.
+     */
     template<class T>
     void SparseMatrix<T>::MltM(const SparseMatrix<T>& B, SparseMatrix<T>& AB) const
     {
+        int m = this->GetM(), n = B.GetN();
         AB.Clear();
-        AB.Reallocate(this->GetM(), B.GetN());
-        T val;
-        for (int k=0; k < B.GetN(); k++)
+        AB.Reallocate(m, n);
+
+        // position(t*n + k) : position de la colonne k dans la ligne courante
+        Vector<int> position(size_t(GetNbThreads())*n);
+        position.Fill(-1);
+
+#pragma omp parallel
         {
-            for (int i = 0; i < this->GetM(); i++)
+            int* pos = &position.GetData()[size_t(GetThreadNumber())*n];
+            Vector<int> col;
+            Vector<T> val;
+#pragma omp for schedule(dynamic, 64)
+            for (int i = 0; i < m; i++)
             {
-                val = 0;
+                int nb = 0;
                 for (int j = 0; j < this->GetRowSize(i); j++)
-                    val += this->Value(i, j)*B(this->Index(i,j), k);
-                
-                AB.AddInteraction(i, k, val);
+                    nb += B.GetRowSize(this->Index(i, j));
+
+                if (col.GetM() < nb)
+                {
+                    col.Reallocate(nb);
+                    val.Reallocate(nb);
+                }
+
+                nb = 0;
+                for (int j = 0; j < this->GetRowSize(i); j++)
+                {
+                    int k = this->Index(i, j);
+                    for (int l = 0; l < B.GetRowSize(k); l++)
+                    {
+                        int c = B.Index(k, l);
+                        if (pos[c] < 0)
+                        {
+                            pos[c] = nb;
+                            col(nb) = c;
+                            val(nb) = this->Value(i, j)*B.Value(k, l);
+                            nb++;
+                        }
+                        else
+                            val(pos[c]) += this->Value(i, j)*B.Value(k, l);
+                    }
+                }
+
+                sort(col.GetData(), col.GetData() + nb);
+                SparseVector<T>& row = AB.GetLine(i);
+                row.Reallocate(nb);
+                for (int j = 0; j < nb; j++)
+                {
+                    row.Index(j) = col(j);
+                    row.Value(j) = val(pos[col(j)]);
+                }
+
+                for (int j = 0; j < nb; j++)
+                    pos[col(j)] = -1;
             }
         }
     }
     
     //! Transpose la matrice
+    /*!
+      On compte d'abord le nombre d'elements de chaque colonne, ce qui permet
+      d'allouer chaque ligne de B une seule fois, puis on remplit B en une passe.
+      Les lignes de A sont decoupees en blocs contigus (un par thread), chaque
+      bloc ecrivant a partir de son propre decalage dans les lignes de B, si bien
+      que les numeros de colonne de B restent tries.
+     */
     template<class T>
     void SparseMatrix<T>::Transpose(SparseMatrix<T>& B) const
     {
+        int m = this->GetM(), n = this->GetN();
+        // le coloriage de B est efface ici, avant la boucle parallele
         B.Clear();
-        B.Reallocate(this->GetN(), this->GetM());
-        for (int i = 0; i < this->GetM(); i++)
+        B.Reallocate(n, m);
+
+        int nb_threads = GetNbThreads();
+        if (nb_threads > m)
+            nb_threads = max(m, 1);
+
+        // offset(t*n + j) : nombre d'elements de la colonne j dans le bloc t
+        Vector<int> offset(size_t(nb_threads)*n);
+        offset.Zero();
+
+#pragma omp parallel for schedule(static)
+        for (int t = 0; t < nb_threads; t++)
         {
-            for (int j = 0; j < this->GetRowSize(i); j++)
-                B.AddInteraction(this->Index(i,j), i, this->Value(i,j));
+            int* count = &offset.GetData()[size_t(t)*n];
+            for (int i = t*m/nb_threads; i < (t+1)*m/nb_threads; i++)
+                for (int j = 0; j < this->GetRowSize(i); j++)
+                    count[this->Index(i, j)]++;
+        }
+
+        // somme cumulee sur les blocs : offset devient la position de depart
+        // du bloc t dans la ligne j de B
+#pragma omp parallel for schedule(static)
+        for (int j = 0; j < n; j++)
+        {
+            int nb = 0;
+            for (int t = 0; t < nb_threads; t++)
+            {
+                int size = offset(size_t(t)*n + j);
+                offset(size_t(t)*n + j) = nb;
+                nb += size;
+            }
+
+            B.ResizeRow(j, nb);
+        }
+
+#pragma omp parallel for schedule(static)
+        for (int t = 0; t < nb_threads; t++)
+        {
+            int* pos = &offset.GetData()[size_t(t)*n];
+            for (int i = t*m/nb_threads; i < (t+1)*m/nb_threads; i++)
+                for (int j = 0; j < this->GetRowSize(i); j++)
+                {
+                    int col = this->Index(i, j);
+                    B.Index(col, pos[col]) = i;
+                    B.Value(col, pos[col]) = this->Value(i, j);
+                    pos[col]++;
+                }
         }
     }
     
@@ -257,10 +633,10 @@ namespace linalg
   template<class T>
   void SparseMatrix<T>::MltAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const
   {
-    T val;
+#pragma omp parallel for schedule(static)
     for (int i = 0; i < this->GetM(); i++)
       {
-	val = 0;
+	T val = 0;
 	for (int j = 0; j < this->GetRowSize(i); j++)
 	  val += this->Value(i, j)*x(this->Index(i, j));
 	
@@ -269,6 +645,56 @@ namespace linalg
   }
   
   
+  //! Effectue le produit Y = A X pour nrhs vecteurs entrelaces
+  /*!
+    Chaque element de A est lu une seule fois pour les nrhs vecteurs
+    (X(nrhs*i + k) est la composante i du vecteur k).
+   */
+  template<class T>
+  void SparseMatrix<T>::MltBlock(int nrhs, const Vector<T>& X, Vector<T>& Y) const
+  {
+    Y.Reallocate(size_t(nrhs)*this->GetM());
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < this->GetM(); i++)
+      {
+	T* y = &Y.GetData()[size_t(nrhs)*i];
+	for (int k = 0; k < nrhs; k++)
+	  y[k] = T(0);
+	
+	for (int j = 0; j < this->GetRowSize(i); j++)
+	  {
+	    const T& a = this->Value(i, j);
+	    const T* x = &X.GetData()[size_t(nrhs)*this->Index(i, j)];
+	    for (int k = 0; k < nrhs; k++)
+	      y[k] += a*x[k];
+	  }
+      }
+  }
+
+
+  //! Effectue le produit y = A^T x sans former la transposee
+  template<class T>
+  void SparseMatrix<T>::MltTrans(const Vector<T>& x, Vector<T>& y) const
+  {
+    y.Fill(T(0));
+    MltTransAdd(T(1), x, y);
+  }
+
+
+  //! Effectue le produit y = y + alpha A^T x sans former la transposee
+  template<class T>
+  void SparseMatrix<T>::MltTransAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const
+  {
+    T val;
+    for (int i = 0; i < this->GetM(); i++)
+      {
+	val = alpha*x(i);
+	for (int j = 0; j < this->GetRowSize(i); j++)
+	  y(this->Index(i, j)) += this->Value(i, j)*val;
+      }
+  }
+
+
   //! Effectue une iteration de SSOR (Symmetric Successive Over Relaxation)
   template<class T>
   void SparseMatrix<T>::ApplySsor(const Vector<T>& b, const Vector<T>& invDiag,
@@ -299,6 +725,129 @@ namespace linalg
   }
   
 
+  //! Constructeur a partir de la matrice A dont on veut appliquer la transposee
+  template<class T>
+  SparseMatrixTranspose<T>::SparseMatrixTranspose(const SparseMatrix<T>& A)
+    : A_(A)
+  {
+    this->m_ = A.GetN();
+    this->n_ = A.GetM();
+  }
+
+
+  //! Effectue le produit y = A^T x
+  template<class T>
+  void SparseMatrixTranspose<T>::Mlt(const Vector<T>& x, Vector<T>& y) const
+  {
+    A_.MltTrans(x, y);
+  }
+
+
+  //! Effectue le produit y = y + alpha A^T x
+  template<class T>
+  void SparseMatrixTranspose<T>::MltAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const
+  {
+    A_.MltTransAdd(alpha, x, y);
+  }
+
+
+  //! Calcule le coloriage des lignes utilise par ApplyMulticolorSsor
+  /*!
+    Le coloriage est conserve dans la matrice tant que sa structure
+    n'est pas modifiee. Si les lignes sont modifiees directement (GetLine),
+    il faut appeler ClearColoring.
+   */
+  template<class T>
+  void SparseMatrix<T>::ComputeColoring() const
+  {
+    Vector<int> color;
+    int nb_colors = FindGreedyColoring(*this, color);
+
+    // les lignes sont rangees par couleur
+    color_ptr_.Reallocate(nb_colors+1);
+    color_ptr_.Zero();
+    for (int i = 0; i < this->GetM(); i++)
+      color_ptr_(color(i)+1)++;
+
+    for (int c = 0; c < nb_colors; c++)
+      color_ptr_(c+1) += color_ptr_(c);
+
+    color_row_.Reallocate(this->GetM());
+    Vector<int> nb(color_ptr_);
+    for (int i = 0; i < this->GetM(); i++)
+      color_row_(nb(color(i))++) = i;
+  }
+
+
+  //! Efface le coloriage des lignes
+  template<class T>
+  void SparseMatrix<T>::ClearColoring()
+  {
+    color_ptr_.Clear();
+    color_row_.Clear();
+  }
+
+
+  //! Renvoie le nombre de couleurs (0 si le coloriage n'a pas ete calcule)
+  template<class T>
+  int SparseMatrix<T>::GetNbColors() const
+  {
+    return max(color_ptr_.GetM()-1, 0);
+  }
+
+
+  //! Effectue une iteration de SSOR multicouleur
+  /*!
+    Les lignes sont parcourues couleur par couleur (dans l'ordre croissant pour
+    la descente, decroissant pour la remontee). Deux lignes de meme couleur ne
+    sont pas couplees, elles sont donc mises a jour en parallele.
+    Le resultat est celui de ApplySsor sur la matrice renumerotee par couleur.
+    Le coloriage doit avoir ete calcule par ComputeColoring (il n'est pas
+    calcule ici pour que plusieurs resolutions puissent partager la matrice).
+   */
+  template<class T>
+  void SparseMatrix<T>::ApplyMulticolorSsor(const Vector<T>& b, const Vector<T>& invDiag,
+					    Vector<T>& x, double omega) const
+  {
+    if ((color_ptr_.GetM() == 0) && (this->GetM() > 0))
+      {
+	cout << "ComputeColoring doit etre appele avant ApplyMulticolorSsor" << endl;
+	abort();
+      }
+
+    int nb_colors = GetNbColors();
+    // etape de descente
+    for (int c = 0; c < nb_colors; c++)
+      {
+#pragma omp parallel for schedule(static)
+	for (int k = color_ptr_(c); k < color_ptr_(c+1); k++)
+	  {
+	    int i = color_row_(k);
+	    T val = b(i);
+	    for (int j = 0; j < this->GetRowSize(i); j++)
+	      val -= this->Value(i, j)*x(this->Index(i, j));
+
+	    x(i) += omega*val*invDiag(i);
+	  }
+      }
+
+    // remontee
+    for (int c = nb_colors-1; c >= 0; c--)
+      {
+#pragma omp parallel for schedule(static)
+	for (int k = color_ptr_(c); k < color_ptr_(c+1); k++)
+	  {
+	    int i = color_row_(k);
+	    T val = b(i);
+	    for (int j = 0; j < this->GetRowSize(i); j++)
+	      val -= this->Value(i, j)*x(this->Index(i, j));
+
+	    x(i) += omega*val*invDiag(i);
+	  }
+      }
+  }
+
+
   //! Writes the content of the matrix in a text file
   template<class T>
   void SparseMatrix<T>::WriteText(const string& FileName) const
@@ -322,6 +871,40 @@ namespace linalg
   }
   
   
+  //! Calcule une empreinte (hachage 64 bits) de la structure et des valeurs de A
+  /*!
+    Deux matrices identiques bit a bit ont la meme empreinte. Chaque ligne est
+    hachee independamment (FNV-1a sur les indices et les octets des valeurs,
+    initialise par le numero de ligne), puis les empreintes des lignes sont
+    melangees et sommees, ce qui permet de traiter les lignes en parallele.
+   */
+  template<class T>
+  uint64_t GetHashValue(const SparseMatrix<T>& A)
+  {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = uint64_t(A.GetM())*prime + uint64_t(A.GetN());
+#pragma omp parallel for schedule(static) reduction(+:hash)
+    for (int i = 0; i < A.GetM(); i++)
+      {
+	uint64_t h = 14695981039346656037ULL ^ uint64_t(i);
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  {
+	    h = (h ^ uint64_t(A.Index(i, j))) * prime;
+	    const unsigned char* byte = reinterpret_cast<const unsigned char*>(&A.Value(i, j));
+	    for (size_t k = 0; k < sizeof(T); k++)
+	      h = (h ^ byte[k]) * prime;
+	  }
+	
+	// melange final (splitmix64) pour que la somme reste discriminante
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	hash += h ^ (h >> 31);
+      }
+    
+    return hash;
+  }
+  
+  
   //! Ecrit la matrice A
   template<class T>
   ostream& operator<<(ostream& out, const SparseMatrix<T>& A)
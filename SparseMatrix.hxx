@@ -21,6 +21,7 @@ namespace linalg
     
     virtual void Mlt(const Vector<T>& x, Vector<T>& y) const;
     virtual void MltAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const;
+    virtual void MltBlock(int nrhs, const Vector<T>& X, Vector<T>& Y) const;
     
   };
 
@@ -32,6 +33,19 @@ namespace linalg
   protected:
     //! lignes de la matrice
     Vector<SparseVector<T> > val_;
+    //! si true, AddInteraction ne modifie plus la structure de la matrice
+    bool pattern_frozen_;
+    //! lignes classees par couleur (calculees par ComputeColoring pour le SSOR multicouleur)
+    mutable Vector<int> color_ptr_, color_row_;
+    
+    void ResizeRow(int i, int n);
+
+    template<class T0>
+    friend void AddSymbolic(const SparseMatrix<T0>& A, const SparseMatrix<T0>& B,
+			    SparseMatrix<T0>& C);
+
+    template<class T0>
+    friend void ApplyPermutation(SparseMatrix<T0>& A, const Vector<int>& perm);
     
   public:
     SparseMatrix();
@@ -56,12 +70,23 @@ namespace linalg
     const T operator()(int i, int j) const;
     
     void AddInteraction(int i, int j, const T& x);
+    int FindIndex(int i, int j) const;
+
+    void FreezePattern();
+    void UnfreezePattern();
+    bool IsPatternFrozen() const;
+    void ZeroValues();
 
     void Mlt(const Vector<T>& x, Vector<T>& y) const;
     void MltAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const;
+    void MltBlock(int nrhs, const Vector<T>& X, Vector<T>& Y) const;
+
+    void MltTrans(const Vector<T>& x, Vector<T>& y) const;
+    void MltTransAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const;
     
     void AddM(const SparseMatrix<T>& B, SparseMatrix<T>& C) const;
     void MltConst(const T& val, SparseMatrix<T>& B);
+    SparseMatrix<T>& operator*=(const T& alpha);
       
     void Transpose(SparseMatrix<T>& B) const;
     void MltM(const SparseMatrix<T>& B, SparseMatrix<T>& AB) const;
@@ -69,10 +94,50 @@ namespace linalg
     void ApplySsor(const Vector<T>& b, const Vector<T>& diag,
 		   Vector<T>& x, double omega) const;
 
+    void ComputeColoring() const;
+    void ClearColoring();
+    int GetNbColors() const;
+    void ApplyMulticolorSsor(const Vector<T>& b, const Vector<T>& invDiag,
+			     Vector<T>& x, double omega) const;
+
     void WriteText(const string&) const;
     
   };
 
+
+  template<class T>
+  void AddSymbolic(const SparseMatrix<T>& A, const SparseMatrix<T>& B, SparseMatrix<T>& C);
+
+  template<class T>
+  void AddNumeric(const T& alpha, const SparseMatrix<T>& A,
+		  const T& beta, const SparseMatrix<T>& B, SparseMatrix<T>& C);
+  
+  template<class T>
+  void Add(const T& alpha, const SparseMatrix<T>& A,
+	   const T& beta, const SparseMatrix<T>& B, SparseMatrix<T>& C);
+
+  template<class T>
+  void Add(const T& alpha, const SparseMatrix<T>& B, SparseMatrix<T>& A);
+  
+  template<class T>
+  uint64_t GetHashValue(const SparseMatrix<T>& A);
+  
+  //! Transposee implicite d'une matrice creuse (A^T n'est pas stockee)
+  template<class T>
+  class SparseMatrixTranspose : public VirtualMatrix<T>
+  {
+  protected:
+    //! matrice dont on applique la transposee
+    const SparseMatrix<T>& A_;
+    
+  public:
+    SparseMatrixTranspose(const SparseMatrix<T>& A);
+    
+    void Mlt(const Vector<T>& x, Vector<T>& y) const;
+    void MltAdd(const T& alpha, const Vector<T>& x, Vector<T>& y) const;
+    
+  };
+  
   template<class T>
   ostream& operator<<(ostream& out, const SparseMatrix<T>& A);
   
@@ -68,9 +68,16 @@ namespace linalg
   template<class T>
   void SparseVector<T>::AddInteraction(int j, const T& val)
   {
-    int k = 0;
-    while ((k < index.GetM()) && (index(k) < j))
-      k++;
+    // recherche dichotomique de la position de j
+    int k = 0, kmax = index.GetM();
+    while (k < kmax)
+      {
+	int kmid = (k + kmax)/2;
+	if (index(kmid) < j)
+	  k = kmid + 1;
+	else
+	  kmax = kmid;
+      }
     
     if (k < index.GetM())
       {
@@ -105,16 +112,34 @@ namespace linalg
   template<class T>
   const T SparseVector<T>::operator()(int j) const
   {
-    int k = 0;
-    while ((k < index.GetM()) && (index(k) < j))
-      k++;
-    
-    if ((k < index.GetM()) && (index(k) == j))
+    int k = FindIndex(j);
+    if (k >= 0)
       return values(k);
     
     return T(0);
   }
   
+  //! Renvoie la position de la colonne j parmi les elements non-nuls (-1 si absente)
+  template<class T>
+  int SparseVector<T>::FindIndex(int j) const
+  {
+    // recherche dichotomique, les numeros de colonne etant tries
+    int kmin = 0, kmax = index.GetM();
+    while (kmin < kmax)
+      {
+	int kmid = (kmin + kmax)/2;
+	if (index(kmid) < j)
+	  kmin = kmid + 1;
+	else
+	  kmax = kmid;
+      }
+    
+    if ((kmin < index.GetM()) && (index(kmin) == j))
+      return kmin;
+    
+    return -1;
+  }
+  
   //! Imprime le vecteur creux
   template<class T>
   ostream& operator<<(ostream& out, const SparseVector<T>& v)
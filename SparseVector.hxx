@@ -25,6 +25,7 @@ namespace linalg
     const T& Value(int j) const;
 
     const T operator()(int i) const;
+    int FindIndex(int j) const;
     
     void AddInteraction(int j, const T& val);
     
@@ -0,0 +1,284 @@
+#ifndef LINALG_FILE_TRIANGULAR_SOLVE_CXX
+
+#include "TriangularSolve.hxx"
+
+namespace linalg
+{
+
+  /********************
+   * TriangularSolver *
+   ********************/
+
+
+  //! Constructeur par defaut
+  template<class T>
+  TriangularSolver<T>::TriangularSolver()
+  {
+    lower_ = true;
+    sync_free_ = false;
+  }
+
+
+  //! Extrait la partie triangulaire de A et calcule les niveaux
+  /*!
+    \param[in] A matrice dont seule la partie triangulaire est utilisee
+    (par exemple la partie inferieure de A pour Gauss-Seidel)
+    \param[in] lower true pour la partie inferieure, false pour la partie superieure
+    \param[in] unit_diag si true, la diagonale de A est ignoree et remplacee par 1
+   */
+  template<class T>
+  void TriangularSolver<T>::Init(const SparseMatrix<T>& A, bool lower, bool unit_diag)
+  {
+    int n = A.GetM();
+    lower_ = lower;
+    ptr_.Reallocate(n+1);
+    ptr_(0) = 0;
+    for (int i = 0; i < n; i++)
+      {
+	int nb = 0;
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if ((lower && (A.Index(i, j) < i)) || (!lower && (A.Index(i, j) > i)))
+	    nb++;
+
+	ptr_(i+1) = ptr_(i) + nb;
+      }
+
+    ind_.Reallocate(ptr_(n));
+    val_.Reallocate(ptr_(n));
+    if (unit_diag)
+      invDiag_.Clear();
+    else
+      invDiag_.Reallocate(n);
+
+    for (int i = 0; i < n; i++)
+      {
+	int nb = ptr_(i);
+	bool diag = false;
+	for (int j = 0; j < A.GetRowSize(i); j++)
+	  if ((lower && (A.Index(i, j) < i)) || (!lower && (A.Index(i, j) > i)))
+	    {
+	      ind_(nb) = A.Index(i, j);
+	      val_(nb) = A.Value(i, j);
+	      nb++;
+	    }
+	  else if ((A.Index(i, j) == i) && !unit_diag && (A.Value(i, j) != T(0)))
+	    {
+	      invDiag_(i) = T(1) / A.Value(i, j);
+	      diag = true;
+	    }
+
+	if (!unit_diag && !diag)
+	  {
+	    cout << "le coefficient diagonal " << i << " est nul" << endl;
+	    abort();
+	  }
+      }
+
+    GetLevelSets(ptr_, ind_, lower, level_ptr_, level_row_);
+  }
+
+
+  //! Efface la matrice triangulaire et les niveaux
+  template<class T>
+  void TriangularSolver<T>::Clear()
+  {
+    ptr_.Clear(); ind_.Clear(); val_.Clear();
+    invDiag_.Clear();
+    level_ptr_.Clear(); level_row_.Clear();
+  }
+
+
+  //! Choix de la variante sans synchronisation par niveau
+  template<class T>
+  void TriangularSolver<T>::SetSyncFree(bool sync_free)
+  {
+    sync_free_ = sync_free;
+  }
+
+
+  //! Retourne le nombre de niveaux (longueur du chemin critique)
+  template<class T>
+  int TriangularSolver<T>::GetNbLevels() const
+  {
+    return max(level_ptr_.GetM()-1, 0);
+  }
+
+
+  //! Resout le systeme triangulaire
+  /*!
+    \param[inout] x second membre en entree, solution en sortie
+   */
+  template<class T>
+  void TriangularSolver<T>::Solve(Vector<T>& x) const
+  {
+    if (sync_free_)
+      SolveTriangularSyncFree(ptr_, ind_, val_, invDiag_, level_row_, x);
+    else if (lower_)
+      SolveLowerTriangular(ptr_, ind_, val_, invDiag_, level_ptr_, level_row_, x);
+    else
+      SolveUpperTriangular(ptr_, ind_, val_, invDiag_, level_ptr_, level_row_, x);
+  }
+
+
+  /***************************
+   * Fonctions au format CSR *
+   ***************************/
+
+
+  //! Calcule les niveaux d'une matrice triangulaire stockee au format CSR
+  /*!
+    \param[in] ptr, ind structure de la matrice (format CSR)
+    \param[in] lower true pour une descente (seuls les ind(j) < i sont pris en compte),
+    false pour une remontee (seuls les ind(j) > i sont pris en compte)
+    \param[out] level_ptr les lignes du niveau l sont
+    level_row(level_ptr(l)), ..., level_row(level_ptr(l+1)-1)
+    \param[out] level_row lignes classees par niveau
+    Les lignes d'un meme niveau ne dependent que des niveaux precedents,
+    elles peuvent donc etre resolues en parallele.
+   */
+  void GetLevelSets(const Vector<int>& ptr, const Vector<int>& ind, bool lower,
+		    Vector<int>& level_ptr, Vector<int>& level_row)
+  {
+    int n = ptr.GetM() - 1, nb_levels = 0;
+    Vector<int> level(n);
+    for (int k = 0; k < n; k++)
+      {
+	int i = lower ? k : n-1-k;
+	int lev = 0;
+	for (int j = ptr(i); j < ptr(i+1); j++)
+	  if ((lower && (ind(j) < i)) || (!lower && (ind(j) > i)))
+	    lev = max(lev, level(ind(j)) + 1);
+
+	level(i) = lev;
+	nb_levels = max(nb_levels, lev+1);
+      }
+
+    // tri des lignes par niveau
+    level_ptr.Reallocate(nb_levels+1);
+    level_ptr.Zero();
+    for (int i = 0; i < n; i++)
+      level_ptr(level(i)+1)++;
+
+    for (int l = 0; l < nb_levels; l++)
+      level_ptr(l+1) += level_ptr(l);
+
+    level_row.Reallocate(n);
+    Vector<int> nb(level_ptr);
+    for (int i = 0; i < n; i++)
+      level_row(nb(level(i))++) = i;
+  }
+
+
+  //! Resout L x = b avec L triangulaire inferieure stockee au format CSR
+  /*!
+    \param[in] ptr, ind, val partie strictement inferieure de L
+    \param[in] invDiag inverse de la diagonale de L (si vide, la diagonale vaut 1)
+    \param[in] level_ptr, level_row niveaux calcules par GetLevelSets
+    \param[inout] x second membre b en entree, solution en sortie
+   */
+  template<class T>
+  void SolveLowerTriangular(const Vector<int>& ptr, const Vector<int>& ind,
+			    const Vector<T>& val, const Vector<T>& invDiag,
+			    const Vector<int>& level_ptr, const Vector<int>& level_row,
+			    Vector<T>& x)
+  {
+    bool unit_diag = (invDiag.GetM() == 0);
+    for (int l = 0; l < level_ptr.GetM()-1; l++)
+      {
+#pragma omp parallel for schedule(static)
+	for (int k = level_ptr(l); k < level_ptr(l+1); k++)
+	  {
+	    int i = level_row(k);
+	    T sum = x(i);
+	    for (int j = ptr(i); j < ptr(i+1); j++)
+	      sum -= val(j)*x(ind(j));
+
+	    x(i) = unit_diag ? sum : sum*invDiag(i);
+	  }
+      }
+  }
+
+
+  //! Resout U x = b avec U triangulaire superieure stockee au format CSR
+  /*!
+    \param[in] ptr, ind, val partie strictement superieure de U
+    \param[in] invDiag inverse de la diagonale de U (si vide, la diagonale vaut 1)
+    \param[in] level_ptr, level_row niveaux calcules par GetLevelSets
+    \param[inout] x second membre b en entree, solution en sortie
+   */
+  template<class T>
+  void SolveUpperTriangular(const Vector<int>& ptr, const Vector<int>& ind,
+			    const Vector<T>& val, const Vector<T>& invDiag,
+			    const Vector<int>& level_ptr, const Vector<int>& level_row,
+			    Vector<T>& x)
+  {
+    // les niveaux d'une remontee sont deja ordonnes a partir de la derniere ligne
+    SolveLowerTriangular(ptr, ind, val, invDiag, level_ptr, level_row, x);
+  }
+
+
+  //! Resout un systeme triangulaire sans synchronisation entre niveaux
+  /*!
+    \param[in] ptr, ind, val partie strictement triangulaire (format CSR)
+    \param[in] invDiag inverse de la diagonale (si vide, la diagonale vaut 1)
+    \param[in] level_row lignes classees par niveau (GetLevelSets), la meme
+    fonction sert donc aux descentes et aux remontees
+    \param[inout] x second membre b en entree, solution en sortie
+    Les lignes sont distribuees par paquets aux threads dans l'ordre des
+    niveaux. Chaque thread traite ses lignes dans cet ordre et attend
+    (attente active) que les lignes dont elles dependent soient marquees
+    comme resolues. La ligne non resolue la plus ancienne a toujours ses
+    dependances resolues, il n'y a donc pas d'interblocage.
+   */
+  template<class T>
+  void SolveTriangularSyncFree(const Vector<int>& ptr, const Vector<int>& ind,
+			       const Vector<T>& val, const Vector<T>& invDiag,
+			       const Vector<int>& level_row, Vector<T>& x)
+  {
+    int n = level_row.GetM();
+    bool unit_diag = (invDiag.GetM() == 0);
+    Vector<int> ready(n);
+    ready.Zero();
+
+#pragma omp parallel
+    {
+      int nb_threads = 1, t = 0;
+#ifdef _OPENMP
+      nb_threads = omp_get_num_threads();
+      t = omp_get_thread_num();
+#endif
+      const int chunk = 32;
+      for (int start = t*chunk; start < n; start += nb_threads*chunk)
+	for (int k = start; k < min(start + chunk, n); k++)
+	  {
+	    int i = level_row(k);
+	    T sum = x(i);
+	    for (int j = ptr(i); j < ptr(i+1); j++)
+	      {
+		int col = ind(j), flag = 0, nb_wait = 0;
+		while (flag == 0)
+		  {
+#pragma omp atomic read
+		    flag = ready(col);
+
+		    // on rend la main si les threads sont plus nombreux que les coeurs
+		    if ((flag == 0) && (++nb_wait > 1000))
+		      this_thread::yield();
+		  }
+
+#pragma omp flush
+		sum -= val(j)*x(col);
+	      }
+
+	    x(i) = unit_diag ? sum : sum*invDiag(i);
+#pragma omp flush
+#pragma omp atomic write
+	    ready(i) = 1;
+	  }
+    }
+  }
+
+}
+
+#define LINALG_FILE_TRIANGULAR_SOLVE_CXX
+#endif
@@ -0,0 +1,68 @@
+#ifndef LINALG_FILE_TRIANGULAR_SOLVE_HXX
+
+namespace linalg
+{
+
+  //! Resolution de systemes triangulaires creux
+  /*!
+    La partie triangulaire (inferieure ou superieure) d'une SparseMatrix est
+    copiee au format CSR, les dependances entre lignes (niveaux) sont
+    analysees une seule fois par Init, puis chaque appel a Solve resout
+    en parallele, soit niveau par niveau (une synchronisation par niveau),
+    soit sans synchronisation globale : chaque ligne attend que les lignes
+    dont elle depend soient marquees comme resolues.
+   */
+  template<class T>
+  class TriangularSolver
+  {
+  protected:
+    //! partie strictement triangulaire au format CSR
+    Vector<int> ptr_, ind_;
+    Vector<T> val_;
+    //! inverse de la diagonale (vide si la diagonale vaut 1)
+    Vector<T> invDiag_;
+    //! niveaux
+    Vector<int> level_ptr_, level_row_;
+    //! true pour une matrice triangulaire inferieure
+    bool lower_;
+    //! true pour la variante sans synchronisation par niveau
+    bool sync_free_;
+
+  public:
+    TriangularSolver();
+
+    void Init(const SparseMatrix<T>& A, bool lower, bool unit_diag = false);
+    void Clear();
+
+    void SetSyncFree(bool sync_free);
+    int GetNbLevels() const;
+
+    void Solve(Vector<T>& x) const;
+
+  };
+
+
+  void GetLevelSets(const Vector<int>& ptr, const Vector<int>& ind, bool lower,
+		    Vector<int>& level_ptr, Vector<int>& level_row);
+
+  template<class T>
+  void SolveLowerTriangular(const Vector<int>& ptr, const Vector<int>& ind,
+			    const Vector<T>& val, const Vector<T>& invDiag,
+			    const Vector<int>& level_ptr, const Vector<int>& level_row,
+			    Vector<T>& x);
+
+  template<class T>
+  void SolveUpperTriangular(const Vector<int>& ptr, const Vector<int>& ind,
+			    const Vector<T>& val, const Vector<T>& invDiag,
+			    const Vector<int>& level_ptr, const Vector<int>& level_row,
+			    Vector<T>& x);
+
+  template<class T>
+  void SolveTriangularSyncFree(const Vector<int>& ptr, const Vector<int>& ind,
+			       const Vector<T>& val, const Vector<T>& invDiag,
+			       const Vector<int>& level_row, Vector<T>& x);
+
+}
+
+#define LINALG_FILE_TRIANGULAR_SOLVE_HXX
+#endif
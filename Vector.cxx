@@ -515,6 +515,25 @@ namespace linalg
   }
 
 
+  inline double conjugate(const double& x)
+  {
+    return x;
+  }
+
+
+  inline float conjugate(const float& x)
+  {
+    return x;
+  }
+
+
+  template<class T>
+  inline complex<T> conjugate(const complex<T>& x)
+  {
+    return conj(x);
+  }
+
+
   template<class T>
   inline void GetRand(T& x)
   {
@@ -545,6 +564,16 @@ namespace linalg
     return sum;
   }
 
+  template<class T>
+  T DotProdConj(const Vector<T>& x, const Vector<T>& y)
+  {
+    T sum(0);
+    for (int i = 0; i < x.GetM(); i++)
+      sum += conjugate(x(i))*y(i);
+    
+    return sum;
+  }
+
   template<class T>
   T Norm2(const Vector<T>& x)
   {
@@ -60,6 +60,12 @@ namespace linalg
     
   };
 
+  double conjugate(const double& x);
+  float conjugate(const float& x);
+
+  template<class T>
+  complex<T> conjugate(const complex<T>& x);
+
   template<class T>
   void GetRand(T& x);
 
@@ -69,6 +75,9 @@ namespace linalg
   template<class T>
   T DotProd(const Vector<T>& x, Vector<T>& y);
 
+  template<class T>
+  T DotProdConj(const Vector<T>& x, const Vector<T>& y);
+
   template<class T>
   T Norm2(const Vector<T>& x);
 